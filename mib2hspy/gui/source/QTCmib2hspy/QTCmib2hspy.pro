@@ -1,19 +1,81 @@
-QT       += core gui
+QT       += core gui network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++11
 
+# The unpack kernels in bitunpack.cpp carry AVX2/NEON paths selected at
+# compile time; enable AVX2 on the x86 converter boxes.
+linux-g++|macx-clang: QMAKE_CXXFLAGS += -mavx2
+win32-msvc: QMAKE_CXXFLAGS += /arch:AVX2
+
+# The streaming .hspy writer needs HDF5 (>= 1.10.3 for H5Dwrite_chunk) and
+# zlib for the chunk deflate stage.
+LIBS += -lhdf5 -lz -lzstd -llz4
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    bitunpack.cpp \
+    calibrationindex.cpp \
+    chunkjournal.cpp \
+    conversionpipeline.cpp \
+    decodekernels.cpp \
+    framebrowser.cpp \
+    glframeview.cpp \
+    framebufferpool.cpp \
+    framecache.cpp \
+    hdrparser.cpp \
+    headlessconverter.cpp \
+    hspywriter.cpp \
+    livewatcher.cpp \
+    mibindex.cpp \
+    pipelineprofiler.cpp \
+    profilerpanel.cpp \
+    pixelcorrector.cpp \
+    previewengine.cpp \
+    reshapemapper.cpp \
+    streamingstats.cpp \
     main.cpp \
-    mib2hspymainwindow.cpp
+    merlincapture.cpp \
+    mib2hspymainwindow.cpp \
+    mibfileset.cpp \
+    quicklook.cpp \
+    settingsstore.cpp \
+    vdsmerge.cpp \
+    mibreader.cpp
 
 HEADERS += \
-    mib2hspymainwindow.h
+    bitunpack.h \
+    calibrationindex.h \
+    chunkjournal.h \
+    conversionpipeline.h \
+    decodekernels.h \
+    framebrowser.h \
+    glframeview.h \
+    framebufferpool.h \
+    framecache.h \
+    hdrparser.h \
+    headlessconverter.h \
+    hspywriter.h \
+    livewatcher.h \
+    mibindex.h \
+    pipelineprofiler.h \
+    profilerpanel.h \
+    pixelcorrector.h \
+    previewengine.h \
+    reshapemapper.h \
+    streamingstats.h \
+    merlincapture.h \
+    mib2hspymainwindow.h \
+    memorybudget.h \
+    mibfileset.h \
+    quicklook.h \
+    settingsstore.h \
+    vdsmerge.h \
+    mibreader.h
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
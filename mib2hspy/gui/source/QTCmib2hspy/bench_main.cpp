@@ -0,0 +1,195 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <cstdio>
+
+#include "bitunpack.h"
+#include "conversionpipeline.h"
+#include "hspywriter.h"
+#include "mibindex.h"
+#include "mibreader.h"
+
+// mib_bench: per-stage throughput numbers for the native conversion engine.
+//
+// Either replays an existing .mib (--input) or synthesizes a raw-mode 12-bit
+// stack, then times header parsing, bit-unpacking, HDF5 chunk writing and
+// the end-to-end pipeline. Results go to stdout as one JSON object so the
+// release checklist can diff them across versions and machines.
+
+namespace {
+
+const int kHeaderSize = 384;
+
+// Writes a synthetic raw-mode 12-bit .mib stack with valid MQ1 headers.
+bool synthesizeMib(const QString &fileName, int frames, int width, int height)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    const qint64 rowBytes = MibUnpack::packedRowBytes(width, 12);
+    const qint64 dataSize = rowBytes * height;
+    QByteArray payload(int(dataSize), Qt::Uninitialized);
+    for (int i = 0; i < payload.size(); ++i)
+        payload[i] = char((i * 2654435761u) >> 24); // cheap deterministic noise
+    for (int i = 0; i < frames; ++i) {
+        QByteArray header = QByteArray("MQ1,")
+                + QByteArray::number(i + 1).rightJustified(6, '0') + ','
+                + QByteArray::number(kHeaderSize).rightJustified(5, '0')
+                + ",01,"
+                + QByteArray::number(width).rightJustified(4, '0') + ','
+                + QByteArray::number(height).rightJustified(4, '0')
+                + ",R64,1x1,01,2026-01-01 00:00:00.000,0.001000,";
+        header.resize(kHeaderSize);
+        file.write(header);
+        file.write(payload);
+    }
+    return true;
+}
+
+double gibPerSecond(qint64 bytes, qint64 nsecs)
+{
+    if (nsecs <= 0)
+        return 0.0;
+    return (double(bytes) / (1024.0 * 1024.0 * 1024.0)) / (double(nsecs) * 1e-9);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("mib_bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                QStringLiteral("Throughput benchmark for the mib2hspy native engine"));
+    parser.addHelpOption();
+    const QCommandLineOption inputOption(
+                QStringLiteral("input"),
+                QStringLiteral("Replay an existing .mib instead of synthesizing one"),
+                QStringLiteral("file"));
+    const QCommandLineOption framesOption(
+                QStringLiteral("frames"),
+                QStringLiteral("Synthetic frame count (default 4096)"),
+                QStringLiteral("n"), QStringLiteral("4096"));
+    const QCommandLineOption threadsOption(
+                QStringLiteral("threads"),
+                QStringLiteral("Decode worker count (default: all cores)"),
+                QStringLiteral("n"));
+    parser.addOption(inputOption);
+    parser.addOption(framesOption);
+    parser.addOption(threadsOption);
+    parser.process(app);
+
+    QTemporaryDir tempDir;
+    QString mibFile = parser.value(inputOption);
+    if (mibFile.isEmpty()) {
+        mibFile = tempDir.filePath(QStringLiteral("bench.mib"));
+        if (!synthesizeMib(mibFile, parser.value(framesOption).toInt(), 256, 256)) {
+            fprintf(stderr, "mib_bench: could not synthesize %s\n",
+                    qPrintable(mibFile));
+            return 1;
+        }
+    }
+
+    QJsonObject results;
+    QElapsedTimer timer;
+
+    // Stage 1: header parse rate (cold, without a sidecar index).
+    QFile::remove(MibIndex::indexFileName(mibFile));
+    MibReader reader;
+    timer.start();
+    if (!reader.open(mibFile)) {
+        fprintf(stderr, "mib_bench: %s\n", qPrintable(reader.errorString()));
+        return 1;
+    }
+    const qint64 scanNs = timer.nsecsElapsed();
+    const int frames = reader.frameCount();
+    results.insert(QStringLiteral("frames"), frames);
+    results.insert(QStringLiteral("file_bytes"), double(reader.fileSize()));
+    results.insert(QStringLiteral("header_scan_frames_per_s"),
+                   frames / (double(scanNs) * 1e-9));
+
+    // Stage 2: unpack throughput over the packed payload bytes.
+    const MibFrameHeader &proto = reader.frameHeader(0);
+    QVector<quint16> decoded(proto.width * proto.height);
+    qint64 packedBytes = 0;
+    timer.restart();
+    for (int i = 0; i < frames; ++i) {
+        const MibFrameView view = reader.frame(i);
+        if (view.header.rawMode)
+            MibUnpack::unpackFrameU16(view.data, decoded.data(), view.header.width,
+                                      view.header.height, view.header.counterDepth);
+        else
+            memcpy(decoded.data(), view.data,
+                   size_t(qMin<qint64>(view.size, decoded.size() * 2)));
+        packedBytes += view.size;
+    }
+    results.insert(QStringLiteral("unpack_gib_per_s"),
+                   gibPerSecond(packedBytes, timer.nsecsElapsed()));
+
+    // Stage 3: HDF5 chunk write throughput with pre-decoded blocks.
+    {
+        const int chunkFrames = 64;
+        HspyWriter writer;
+        const QString outFile = tempDir.filePath(QStringLiteral("bench_write.hspy"));
+        if (!writer.create(outFile, frames, proto.width, proto.height, chunkFrames)) {
+            fprintf(stderr, "mib_bench: %s\n", qPrintable(writer.errorString()));
+            return 1;
+        }
+        QVector<quint16> storage(proto.width * proto.height * chunkFrames);
+        DecodedBlock block;
+        block.width = proto.width;
+        block.height = proto.height;
+        block.frameCount = chunkFrames;
+        block.pixels = storage.data();
+        block.pixelCount = storage.size();
+        qint64 written = 0;
+        timer.restart();
+        for (int first = 0; first + chunkFrames <= frames; first += chunkFrames) {
+            block.firstFrame = first;
+            writer.writeBlock(block);
+            written += block.pixelCount * 2;
+        }
+        writer.finish();
+        results.insert(QStringLiteral("hdf5_write_gib_per_s"),
+                       gibPerSecond(written, timer.nsecsElapsed()));
+    }
+
+    // Stage 4: end-to-end decode+write pipeline.
+    {
+        HspyWriter writer;
+        const QString outFile = tempDir.filePath(QStringLiteral("bench_e2e.hspy"));
+        if (!writer.create(outFile, frames, proto.width, proto.height, 64)) {
+            fprintf(stderr, "mib_bench: %s\n", qPrintable(writer.errorString()));
+            return 1;
+        }
+        ConversionPipeline pipeline;
+        pipeline.setReader(&reader);
+        pipeline.setBlockSize(writer.chunkFrames());
+        if (parser.isSet(threadsOption))
+            pipeline.setThreadCount(parser.value(threadsOption).toInt());
+        pipeline.setBlockSink([&writer](const DecodedBlock &block) {
+            return writer.writeBlock(block);
+        });
+        QEventLoop loop;
+        QObject::connect(&pipeline, &ConversionPipeline::finished,
+                         &loop, &QEventLoop::quit);
+        timer.restart();
+        pipeline.start();
+        loop.exec();
+        writer.finish();
+        results.insert(QStringLiteral("end_to_end_frames_per_s"),
+                       frames / (double(timer.nsecsElapsed()) * 1e-9));
+    }
+
+    printf("%s\n", QJsonDocument(results).toJson(QJsonDocument::Compact).constData());
+    return 0;
+}
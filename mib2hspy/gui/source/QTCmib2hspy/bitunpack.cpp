@@ -0,0 +1,251 @@
+#include "bitunpack.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace MibUnpack {
+
+namespace {
+
+// Scalar reference kernels. These also mop up the sub-vector-width tails of
+// the SIMD paths, so they must match the packed layout bit for bit.
+
+inline void scalarRow1(const quint8 *src, quint16 *dst, int pixels)
+{
+    for (int x = 0; x < pixels; ++x)
+        dst[x] = (src[x >> 3] >> (7 - (x & 7))) & 1u;
+}
+
+inline void scalarRow6(const quint8 *src, quint16 *dst, int pixels)
+{
+    int x = 0;
+    // 4 pixels per 3 bytes.
+    for (; x + 4 <= pixels; x += 4, src += 3) {
+        dst[x]     = src[0] >> 2;
+        dst[x + 1] = ((src[0] & 0x03u) << 4) | (src[1] >> 4);
+        dst[x + 2] = ((src[1] & 0x0Fu) << 2) | (src[2] >> 6);
+        dst[x + 3] = src[2] & 0x3Fu;
+    }
+    for (; x < pixels; ++x) {
+        const qint64 bit = qint64(x & 3) * 6;
+        quint32 word = 0;
+        for (int b = 0; b < 6; ++b) {
+            const qint64 idx = bit + b;
+            word = (word << 1) | ((src[idx >> 3] >> (7 - (idx & 7))) & 1u);
+        }
+        dst[x] = quint16(word);
+    }
+}
+
+inline void scalarRow12(const quint8 *src, quint16 *dst, int pixels)
+{
+    int x = 0;
+    // 2 pixels per 3 bytes.
+    for (; x + 2 <= pixels; x += 2, src += 3) {
+        dst[x]     = (quint16(src[0]) << 4) | (src[1] >> 4);
+        dst[x + 1] = (quint16(src[1] & 0x0Fu) << 8) | src[2];
+    }
+    if (x < pixels)
+        dst[x] = (quint16(src[0]) << 4) | (src[1] >> 4);
+}
+
+inline void scalarRow24(const quint8 *src, quint32 *dst, int pixels)
+{
+    for (int x = 0; x < pixels; ++x, src += 3)
+        dst[x] = (quint32(src[0]) << 16) | (quint32(src[1]) << 8) | src[2];
+}
+
+} // namespace
+
+#if defined(__AVX2__)
+
+void unpackRow1(const quint8 *src, quint16 *dst, int pixels)
+{
+    // 16 pixels per iteration: broadcast two packed bytes across lanes, mask
+    // out each bit position and compare to produce 0/1 words.
+    const __m256i byteSel = _mm256_setr_epi8(
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m256i bitMask = _mm256_setr_epi16(
+        0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+        0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    int x = 0;
+    for (; x + 16 <= pixels; x += 16, src += 2) {
+        const __m256i bytes = _mm256_shuffle_epi8(
+            _mm256_set1_epi16(*reinterpret_cast<const short *>(src)), byteSel);
+        const __m256i hits = _mm256_and_si256(bytes, bitMask);
+        const __m256i ones = _mm256_srli_epi16(
+            _mm256_cmpeq_epi16(hits, bitMask), 15);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), ones);
+    }
+    if (x < pixels)
+        scalarRow1(src, dst + x, pixels - x);
+}
+
+void unpackRow6(const quint8 *src, quint16 *dst, int pixels)
+{
+    // 16 pixels (12 packed bytes) per iteration. Each 6-bit pixel straddles
+    // at most two bytes; gather those byte pairs into 16-bit lanes, shift
+    // each lane so the pixel sits at bit 0, then mask.
+    static const quint8 shuffleBytes[16] = {
+        0, 1, 0, 1, 1, 2, 2, 3, 3, 4, 3, 4, 4, 5, 5, 6 };
+    const __m128i sel = _mm_loadu_si128(reinterpret_cast<const __m128i *>(shuffleBytes));
+    // Right-shift per lane via multiply by 2^s then a common srli 10: once
+    // the pair is byte-swapped into host order the four pixels of a 3-byte
+    // group sit at bits [15:10], [9:4], [11:6] and [13:8] of their pairs.
+    const __m256i mulShift = _mm256_setr_epi16(
+        1 << 0, 1 << 6, 1 << 4, 1 << 2, 1 << 0, 1 << 6, 1 << 4, 1 << 2,
+        1 << 0, 1 << 6, 1 << 4, 1 << 2, 1 << 0, 1 << 6, 1 << 4, 1 << 2);
+    const __m256i mask = _mm256_set1_epi16(0x3F);
+    int x = 0;
+    // The shuffled loads read a few bytes past the 12 consumed per step, so
+    // stop one group early and let the scalar tail finish the row.
+    for (; x + 24 <= pixels; x += 16, src += 12) {
+        const __m128i lo = _mm_shuffle_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src)), sel);
+        const __m128i hi = _mm_shuffle_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + 6)), sel);
+        __m256i pairs = _mm256_set_m128i(hi, lo);
+        // Packed stream is MSB-first: swap to host order so shifts line up.
+        pairs = _mm256_or_si256(_mm256_slli_epi16(pairs, 8),
+                                _mm256_srli_epi16(pairs, 8));
+        // (pair << s) >> 10 leaves the 6 wanted bits at the bottom.
+        const __m256i shifted = _mm256_srli_epi16(
+            _mm256_mullo_epi16(pairs, mulShift), 10);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x),
+                            _mm256_and_si256(shifted, mask));
+    }
+    if (x < pixels)
+        scalarRow6(src, dst + x, pixels - x);
+}
+
+void unpackRow12(const quint8 *src, quint16 *dst, int pixels)
+{
+    // Hot path: 16 pixels (24 packed bytes) per iteration. Even pixels use
+    // bytes (3k, 3k+1) >> 4, odd pixels bytes (3k+1, 3k+2) & 0xFFF.
+    static const quint8 shuffleBytes[16] = {
+        0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11 };
+    const __m128i sel = _mm_loadu_si128(reinterpret_cast<const __m128i *>(shuffleBytes));
+    const __m256i evenShiftMul = _mm256_setr_epi16(
+        1 << 0, 1 << 4, 1 << 0, 1 << 4, 1 << 0, 1 << 4, 1 << 0, 1 << 4,
+        1 << 0, 1 << 4, 1 << 0, 1 << 4, 1 << 0, 1 << 4, 1 << 0, 1 << 4);
+    int x = 0;
+    // The 16-byte loads read 4 bytes past the 24 consumed per step, so stop
+    // early and let the scalar tail finish the row.
+    for (; x + 24 <= pixels; x += 16, src += 24) {
+        const __m128i lo = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src)), sel);
+        const __m128i hi = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 12)), sel);
+        __m256i pairs = _mm256_set_m128i(hi, lo);
+        pairs = _mm256_or_si256(_mm256_slli_epi16(pairs, 8),
+                                _mm256_srli_epi16(pairs, 8));
+        // Even lanes need >> 4 (multiply by 1, shift 4); odd lanes need the
+        // low 12 bits (multiply by 16 then shift 4 drops the top nibble).
+        const __m256i vals = _mm256_srli_epi16(
+            _mm256_mullo_epi16(pairs, evenShiftMul), 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), vals);
+    }
+    if (x < pixels)
+        scalarRow12(src, dst + x, pixels - x);
+}
+
+#elif defined(__ARM_NEON)
+
+void unpackRow1(const quint8 *src, quint16 *dst, int pixels)
+{
+    scalarRow1(src, dst, pixels);
+}
+
+void unpackRow6(const quint8 *src, quint16 *dst, int pixels)
+{
+    scalarRow6(src, dst, pixels);
+}
+
+void unpackRow12(const quint8 *src, quint16 *dst, int pixels)
+{
+    // 16 pixels per iteration: vld3 de-interleaves the 3-byte pixel pairs
+    // into separate b0/b1/b2 streams.
+    int x = 0;
+    for (; x + 16 <= pixels; x += 16, src += 24) {
+        const uint8x8x3_t b = vld3_u8(src);
+        const uint16x8_t even = vorrq_u16(vshlq_n_u16(vmovl_u8(b.val[0]), 4),
+                                          vshrq_n_u16(vmovl_u8(b.val[1]), 4));
+        const uint16x8_t odd = vorrq_u16(
+            vshlq_n_u16(vandq_u16(vmovl_u8(b.val[1]), vdupq_n_u16(0x0F)), 8),
+            vmovl_u8(b.val[2]));
+        uint16x8x2_t out;
+        out.val[0] = even;
+        out.val[1] = odd;
+        vst2q_u16(dst + x, out);
+    }
+    if (x < pixels)
+        scalarRow12(src, dst + x, pixels - x);
+}
+
+#else
+
+void unpackRow1(const quint8 *src, quint16 *dst, int pixels)
+{
+    scalarRow1(src, dst, pixels);
+}
+
+void unpackRow6(const quint8 *src, quint16 *dst, int pixels)
+{
+    scalarRow6(src, dst, pixels);
+}
+
+void unpackRow12(const quint8 *src, quint16 *dst, int pixels)
+{
+    scalarRow12(src, dst, pixels);
+}
+
+#endif
+
+void unpackRow24(const quint8 *src, quint32 *dst, int pixels)
+{
+    // 24-bit frames are rare enough that the byte-gather loop is fine.
+    scalarRow24(src, dst, pixels);
+}
+
+bool unpackFrameU16(const quint8 *src, quint16 *dst,
+                    int width, int height, int counterDepth)
+{
+    const qint64 rowBytes = packedRowBytes(width, counterDepth);
+    switch (counterDepth) {
+    case 1:
+        for (int y = 0; y < height; ++y)
+            unpackRow1(src + y * rowBytes, dst + qint64(y) * width, width);
+        return true;
+    case 6:
+        for (int y = 0; y < height; ++y)
+            unpackRow6(src + y * rowBytes, dst + qint64(y) * width, width);
+        return true;
+    case 12:
+        for (int y = 0; y < height; ++y)
+            unpackRow12(src + y * rowBytes, dst + qint64(y) * width, width);
+        return true;
+    case 24:
+        // Clamp into the uint16 stream row by row through a small staging
+        // buffer on the stack.
+        for (int y = 0; y < height; ++y) {
+            quint32 staging[1024];
+            const quint8 *row = src + y * rowBytes;
+            quint16 *out = dst + qint64(y) * width;
+            for (int x0 = 0; x0 < width; x0 += 1024) {
+                const int n = qMin(1024, width - x0);
+                unpackRow24(row + qint64(x0) * 3, staging, n);
+                for (int i = 0; i < n; ++i)
+                    out[x0 + i] = staging[i] > 0xFFFF ? 0xFFFF : quint16(staging[i]);
+            }
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace MibUnpack
@@ -0,0 +1,40 @@
+#ifndef BITUNPACK_H
+#define BITUNPACK_H
+
+#include <QtGlobal>
+
+//! Vectorized unpack kernels for Merlin raw-mode (R64) payloads.
+//!
+//! Raw rows pack pixels MSB-first at 1, 6, 12 or 24 bits, padded to whole
+//! 64-bit words. The kernels expand one row at a time into uint16 (uint32
+//! for 24-bit) scanlines. AVX2 and NEON paths are selected at compile time
+//! with a scalar fallback, all behind the same signatures, so callers never
+//! branch on the instruction set.
+namespace MibUnpack {
+
+//! Expands \a pixels 1-bit counters from \a src into \a dst.
+void unpackRow1(const quint8 *src, quint16 *dst, int pixels);
+//! Expands \a pixels 6-bit counters from \a src into \a dst.
+void unpackRow6(const quint8 *src, quint16 *dst, int pixels);
+//! Expands \a pixels 12-bit counters from \a src into \a dst.
+void unpackRow12(const quint8 *src, quint16 *dst, int pixels);
+//! Expands \a pixels 24-bit counters from \a src into \a dst.
+void unpackRow24(const quint8 *src, quint32 *dst, int pixels);
+
+//! Unpacks a whole raw frame into a uint16 scanline buffer. 24-bit counters
+//! are clamped into uint16; use unpackRow24() directly when the full range
+//! is needed. Returns false for unsupported depths.
+bool unpackFrameU16(const quint8 *src, quint16 *dst,
+                    int width, int height, int counterDepth);
+
+//! Bytes per packed row for the given width and depth (rows are padded to
+//! 64-bit words).
+inline qint64 packedRowBytes(int width, int counterDepth)
+{
+    const qint64 bits = qint64(width) * counterDepth;
+    return ((bits + 63) / 64) * 8;
+}
+
+} // namespace MibUnpack
+
+#endif // BITUNPACK_H
@@ -0,0 +1,99 @@
+#include "calibrationindex.h"
+
+#include <QFile>
+#include <QTextStream>
+
+namespace {
+
+// Minimal CSV splitter: handles quoted fields with embedded commas, which
+// the Camera/Microscope columns occasionally contain.
+QStringList splitCsvLine(const QString &line)
+{
+    QStringList fields;
+    QString current;
+    bool quoted = false;
+    for (const QChar c : line) {
+        if (c == QLatin1Char('"')) {
+            quoted = !quoted;
+        } else if (c == QLatin1Char(',') && !quoted) {
+            fields.append(current.trimmed());
+            current.clear();
+        } else {
+            current.append(c);
+        }
+    }
+    fields.append(current.trimmed());
+    return fields;
+}
+
+} // namespace
+
+CalibrationIndex::CalibrationIndex()
+{
+}
+
+bool CalibrationIndex::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+    QTextStream stream(&file);
+
+    // Column positions come from the header row, so column reordering in
+    // the spreadsheet does not break the index.
+    const QStringList header = splitCsvLine(stream.readLine());
+    const int colNominal = header.indexOf(QStringLiteral("Nominal Cameralength (cm)"));
+    const int colActual = header.indexOf(QStringLiteral("Cameralength (cm)"));
+    const int colVoltage = header.indexOf(QStringLiteral("Acceleration Voltage (V)"));
+    const int colCamera = header.indexOf(QStringLiteral("Camera"));
+    const int colMicroscope = header.indexOf(QStringLiteral("Microscope"));
+    const int colScale = header.indexOf(QStringLiteral("Scale (1/Å)"));
+    const int colDate = header.indexOf(QStringLiteral("Date"));
+    if (colNominal < 0 || colVoltage < 0 || colCamera < 0 || colDate < 0) {
+        m_errorString = QStringLiteral("Missing calibration columns in %1").arg(fileName);
+        return false;
+    }
+
+    QHash<CalibrationKey, CalibrationEntry> index;
+    int rows = 0;
+    while (!stream.atEnd()) {
+        const QStringList fields = splitCsvLine(stream.readLine());
+        if (fields.size() <= colDate)
+            continue;
+        CalibrationKey key;
+        bool okNominal = false;
+        bool okVoltage = false;
+        key.nominalCameralength = int(fields.at(colNominal).toDouble(&okNominal));
+        key.accelerationVoltage = int(fields.at(colVoltage).toDouble(&okVoltage));
+        key.camera = fields.at(colCamera);
+        key.microscope = colMicroscope >= 0 ? fields.at(colMicroscope) : QString();
+        if (!okNominal || !okVoltage || key.camera.isEmpty())
+            continue;
+
+        CalibrationEntry entry;
+        entry.date = QDate::fromString(fields.at(colDate), Qt::ISODate);
+        if (colActual >= 0)
+            entry.actualCameralength = fields.at(colActual).toDouble();
+        if (colScale >= 0)
+            entry.scale = fields.at(colScale).toDouble();
+        if (!entry.date.isValid())
+            continue;
+        ++rows;
+
+        // Most-recent-date tie-breaking happens here, at build time, so
+        // lookups never have to compare dates.
+        const CalibrationEntry existing = index.value(key);
+        if (!existing.isValid() || entry.date > existing.date)
+            index.insert(key, entry);
+    }
+    if (index.isEmpty()) {
+        m_errorString = QStringLiteral("No calibration rows in %1").arg(fileName);
+        return false;
+    }
+    m_index = index;
+    m_rowCount = rows;
+    m_errorString.clear();
+    return true;
+}
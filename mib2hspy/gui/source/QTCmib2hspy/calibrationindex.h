@@ -0,0 +1,76 @@
+#ifndef CALIBRATIONINDEX_H
+#define CALIBRATIONINDEX_H
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+
+//! Lookup key for one calibration condition. Matches the query the Python
+//! side runs against the Calibrations table: nominal cameralength,
+//! acceleration voltage, camera and microscope.
+struct CalibrationKey
+{
+    int nominalCameralength = 0;    //!< cm
+    int accelerationVoltage = 0;    //!< V
+    QString camera;
+    QString microscope;
+
+    bool operator==(const CalibrationKey &other) const
+    {
+        return nominalCameralength == other.nominalCameralength
+                && accelerationVoltage == other.accelerationVoltage
+                && camera == other.camera
+                && microscope == other.microscope;
+    }
+};
+
+inline uint qHash(const CalibrationKey &key, uint seed = 0)
+{
+    return ::qHash(key.camera, seed) ^ ::qHash(key.microscope, seed)
+            ^ ::qHash(key.nominalCameralength) ^ ::qHash(uint(key.accelerationVoltage));
+}
+
+//! One resolved calibration row.
+struct CalibrationEntry
+{
+    double actualCameralength = 0.0;    //!< cm
+    double scale = 0.0;                 //!< 1/Å per pixel
+    QDate date;
+    bool isValid() const { return date.isValid(); }
+};
+
+//! Session-lifetime hash index over the calibration table.
+//!
+//! The table is parsed once (from a CSV export of Calibrations.xlsx, which
+//! mirrors what the Python side loads through pandas) into a QHash keyed on
+//! (nominal cameralength, acceleration voltage, camera, microscope). Rows
+//! with the same key are resolved at build time by keeping the most recent
+//! Date, so every lookup from the parameters window is a single probe
+//! instead of a dataframe query.
+class CalibrationIndex
+{
+public:
+    CalibrationIndex();
+
+    //! Parses \a fileName and (re)builds the index. Returns false and keeps
+    //! the previous index on parse failure.
+    bool load(const QString &fileName);
+
+    bool isLoaded() const { return !m_index.isEmpty(); }
+    int rowCount() const { return m_rowCount; }
+    QString errorString() const { return m_errorString; }
+
+    //! Single-probe lookup; returns an invalid entry when the condition has
+    //! no calibration.
+    CalibrationEntry lookup(const CalibrationKey &key) const
+    {
+        return m_index.value(key);
+    }
+
+private:
+    QHash<CalibrationKey, CalibrationEntry> m_index;
+    int m_rowCount = 0;
+    QString m_errorString;
+};
+
+#endif // CALIBRATIONINDEX_H
@@ -0,0 +1,177 @@
+#include "chunkjournal.h"
+
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// On-disk layout, packed little-endian like the .mib sidecar index. The
+// record stream after the header is append-only so a crash can at worst
+// truncate the tail, which the reader tolerates.
+#pragma pack(push, 1)
+struct JournalFileHeader
+{
+    char magic[8];          // "MIBJRN\0\0"
+    quint32 version;
+    quint32 rank;
+    quint32 chunkFrames;
+    quint32 width;
+    quint32 height;
+};
+
+struct JournalRecord
+{
+    quint8 kind;            // 0 = chunk, 1 = barrier
+    quint64 offset0;
+    quint64 offset1;
+};
+#pragma pack(pop)
+
+const char kMagic[8] = { 'M', 'I', 'B', 'J', 'R', 'N', '\0', '\0' };
+const quint32 kVersion = 1;
+const quint8 kChunkRecord = 0;
+const quint8 kBarrierRecord = 1;
+
+} // namespace
+
+ChunkJournal::~ChunkJournal()
+{
+    close(false);
+}
+
+QString ChunkJournal::journalFileName(const QString &outputFile)
+{
+    return outputFile + QStringLiteral(".journal");
+}
+
+quint64 ChunkJournal::chunkKey(const hsize_t *offset, int rank)
+{
+    // Rank 3 chunks are identified by their frame offset alone; rank 4
+    // chunks by (scan row, column start), packed into one word.
+    if (rank == 4)
+        return (quint64(offset[0]) << 32) | quint64(offset[1]);
+    return quint64(offset[0]);
+}
+
+bool ChunkJournal::beginLog(const QString &outputFile, int rank,
+                            int chunkFrames, int width, int height)
+{
+    close(false);
+    m_file.setFileName(journalFileName(outputFile));
+    if (!m_file.open(QIODevice::ReadWrite))
+        return false;
+
+    JournalFileHeader header;
+    if (m_file.size() >= qint64(sizeof(header))
+            && m_file.read(reinterpret_cast<char *>(&header), sizeof(header))
+               == qint64(sizeof(header))
+            && memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+            && header.version == kVersion
+            && header.rank == quint32(rank)
+            && header.chunkFrames == quint32(chunkFrames)
+            && header.width == quint32(width)
+            && header.height == quint32(height)) {
+        // Same job as the interrupted attempt: keep appending.
+        m_file.seek(m_file.size());
+        return true;
+    }
+
+    m_file.resize(0);
+    m_file.seek(0);
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.rank = quint32(rank);
+    header.chunkFrames = quint32(chunkFrames);
+    header.width = quint32(width);
+    header.height = quint32(height);
+    if (m_file.write(reinterpret_cast<const char *>(&header), sizeof(header))
+            != qint64(sizeof(header))) {
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+void ChunkJournal::logChunk(const hsize_t *offset, int rank)
+{
+    if (!m_file.isOpen())
+        return;
+    JournalRecord record;
+    record.kind = kChunkRecord;
+    record.offset0 = quint64(offset[0]);
+    record.offset1 = rank == 4 ? quint64(offset[1]) : 0;
+    m_file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+}
+
+void ChunkJournal::logBarrier()
+{
+    if (!m_file.isOpen())
+        return;
+    JournalRecord record;
+    record.kind = kBarrierRecord;
+    record.offset0 = 0;
+    record.offset1 = 0;
+    m_file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    // flush() only hands the bytes to the OS; the barrier is a durability
+    // promise, so they have to survive a power cut too.
+    m_file.flush();
+#ifdef Q_OS_WIN
+    _commit(m_file.handle());
+#else
+    fsync(m_file.handle());
+#endif
+}
+
+void ChunkJournal::close(bool removeFile)
+{
+    if (!m_file.isOpen()) {
+        if (removeFile && !m_file.fileName().isEmpty())
+            QFile::remove(m_file.fileName());
+        return;
+    }
+    m_file.close();
+    if (removeFile)
+        m_file.remove();
+}
+
+QSet<quint64> ChunkJournal::durableChunks(const QString &outputFile, int rank,
+                                          int chunkFrames, int width, int height)
+{
+    QSet<quint64> durable;
+    QFile file(journalFileName(outputFile));
+    if (!file.open(QIODevice::ReadOnly))
+        return durable;
+
+    JournalFileHeader header;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header))
+            != qint64(sizeof(header))
+            || memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+            || header.version != kVersion
+            || header.rank != quint32(rank)
+            || header.chunkFrames != quint32(chunkFrames)
+            || header.width != quint32(width)
+            || header.height != quint32(height)) {
+        return durable;
+    }
+
+    // Chunks only count once a later barrier confirms they reached disk.
+    QSet<quint64> pending;
+    JournalRecord record;
+    while (file.read(reinterpret_cast<char *>(&record), sizeof(record))
+           == qint64(sizeof(record))) {
+        if (record.kind == kBarrierRecord) {
+            durable += pending;
+            pending.clear();
+        } else {
+            const hsize_t offset[2] = { hsize_t(record.offset0),
+                                        hsize_t(record.offset1) };
+            pending.insert(chunkKey(offset, rank));
+        }
+    }
+    return durable;
+}
@@ -0,0 +1,54 @@
+#ifndef CHUNKJOURNAL_H
+#define CHUNKJOURNAL_H
+
+#include <QFile>
+#include <QSet>
+#include <QString>
+
+#include <hdf5.h>
+
+//! Chunk-level checkpoint journal for resumable conversions.
+//!
+//! The writer appends one record per chunk it has handed to the HDF5 layer
+//! and a barrier record after every H5Fflush. Only chunks logged before the
+//! last barrier are considered durable: everything after it may still have
+//! been in the page cache when power was lost. On restart, the durable set
+//! tells the writer which chunks to skip and where the contiguous prefix
+//! ends, so an interrupted job re-decodes at most the in-flight window. The
+//! journal sits next to the output as <output>.journal and is deleted when
+//! the conversion completes.
+class ChunkJournal
+{
+public:
+    ~ChunkJournal();
+
+    static QString journalFileName(const QString &outputFile);
+
+    //! Opens the journal for appending, writing the geometry header first if
+    //! the file is new. Geometry mismatches invalidate an existing journal.
+    bool beginLog(const QString &outputFile, int rank, int chunkFrames,
+                  int width, int height);
+
+    //! Records one chunk offset; cheap, buffered.
+    void logChunk(const hsize_t *offset, int rank);
+    //! Records a barrier; call right after flushing the HDF5 file. Pushes
+    //! the journal itself to disk.
+    void logBarrier();
+
+    //! Removes the journal (call on successful completion) or just closes
+    //! it, leaving the checkpoint behind for the next attempt.
+    void close(bool removeFile);
+
+    //! Reads the durable chunk set of an earlier attempt. Returns an empty
+    //! set when there is no usable journal for this geometry.
+    static QSet<quint64> durableChunks(const QString &outputFile, int rank,
+                                       int chunkFrames, int width, int height);
+
+    //! Packs a chunk offset into a set key; rank 4 keeps (row, colStart).
+    static quint64 chunkKey(const hsize_t *offset, int rank);
+
+private:
+    QFile m_file;
+};
+
+#endif // CHUNKJOURNAL_H
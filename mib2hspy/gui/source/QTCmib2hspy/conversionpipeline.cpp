@@ -0,0 +1,370 @@
+#include "conversionpipeline.h"
+#include "memorybudget.h"
+#include "pixelcorrector.h"
+#include "streamingstats.h"
+
+#include <QRunnable>
+#include <QThreadPool>
+
+//! One pooled worker: repeatedly claims the next block of frames from the
+//! pipeline's cursor until the file is exhausted.
+class DecodeRangeTask : public QRunnable
+{
+public:
+    explicit DecodeRangeTask(ConversionPipeline *pipeline)
+        : m_pipeline(pipeline)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        int first = 0;
+        int count = 0;
+        while (m_pipeline->claimBlock(&first, &count))
+            m_pipeline->decodeBlock(first, count);
+        m_pipeline->workerFinished();
+    }
+
+private:
+    ConversionPipeline *m_pipeline;
+};
+
+//! Dedicated writer thread draining the ordered block queue.
+class WriterThread : public QThread
+{
+public:
+    explicit WriterThread(ConversionPipeline *pipeline)
+        : m_pipeline(pipeline)
+    {
+    }
+
+protected:
+    void run() override { m_pipeline->drainQueue(); }
+
+private:
+    ConversionPipeline *m_pipeline;
+};
+
+ConversionPipeline::ConversionPipeline(QObject *parent)
+    : QObject(parent)
+{
+    m_threadCount = QThread::idealThreadCount();
+}
+
+ConversionPipeline::~ConversionPipeline()
+{
+    cancel();
+    // The decode workers keep touching the pool, the queue mutex and the
+    // condition variables until they notice the cancel; they must drain
+    // before the members are destroyed — at most one block's decode away.
+    m_decodePool.waitForDone();
+    if (m_writerThread) {
+        m_writerThread->wait();
+        delete m_writerThread;
+    }
+}
+
+void ConversionPipeline::setBlockSize(int frames)
+{
+    m_blockSize = qMax(1, frames);
+}
+
+void ConversionPipeline::setThreadCount(int threads)
+{
+    m_threadCount = qMax(1, threads);
+}
+
+void ConversionPipeline::setStartFrame(int frame)
+{
+    m_startFrame = qMax(0, frame);
+}
+
+void ConversionPipeline::setLiveMode(bool live)
+{
+    m_liveMode = live;
+}
+
+void ConversionPipeline::setExpectedFrames(int frames)
+{
+    m_expectedFrames = qMax(0, frames);
+}
+
+void ConversionPipeline::extendTo(int frames)
+{
+    QMutexLocker locker(&m_liveMutex);
+    if (frames > m_liveAvailable) {
+        m_liveAvailable = frames;
+        m_moreInput.wakeAll();
+    }
+}
+
+void ConversionPipeline::finishInput()
+{
+    QMutexLocker locker(&m_liveMutex);
+    if (m_inputDone)
+        return;
+    m_inputDone = true;
+    // The real total is whatever the acquisition delivered; the success
+    // check and the progress denominator follow it.
+    m_frameCount = m_liveAvailable;
+    m_moreInput.wakeAll();
+}
+
+void ConversionPipeline::start()
+{
+    // An installed frame source replaces the reader outright: a capture
+    // started while a file happens to be open must not inherit that file's
+    // frame count, geometry or decode kernel.
+    const bool haveReader = !m_frameSource && m_reader && m_reader->isOpen();
+    if (!haveReader && !m_frameSource) {
+        emit errorOccurred(QStringLiteral("No .mib file is open"));
+        emit finished(false);
+        return;
+    }
+    if (!m_running.testAndSetAcquire(0, 1))
+        return;
+
+    m_cancelled.storeRelease(0);
+    // Frame total: the reader knows it; a frame source announces it through
+    // setExpectedFrames() (which also overrides in live mode).
+    const int sourceFrames = haveReader ? m_reader->frameCount() : m_expectedFrames;
+    m_frameCount = m_liveMode && m_expectedFrames > 0 ? m_expectedFrames
+                                                      : sourceFrames;
+    const int start = qMin(m_startFrame, m_frameCount);
+    {
+        QMutexLocker locker(&m_liveMutex);
+        m_liveCursor = start;
+        m_liveAvailable = m_liveMode ? (haveReader ? m_reader->frameCount() : 0)
+                                     : m_frameCount;
+        m_inputDone = !m_liveMode;
+    }
+    // Depth and mode are fixed per acquisition, so the specialized decode
+    // kernel is resolved here, once per file. Frame-source runs resolve it
+    // from the first frame they see instead.
+    m_decoder = haveReader
+            ? MibDecode::select(m_reader->frameHeader(0).counterDepth,
+                                m_reader->frameHeader(0).rawMode)
+            : nullptr;
+    m_nextFrame.storeRelease(start);
+    m_framesDone.storeRelease(start);
+    m_nextToWrite = start;
+    m_writerFailed = false;
+    m_pending.clear();
+
+    if (m_writerThread) {
+        m_writerThread->wait();
+        delete m_writerThread;
+    }
+    m_writerThread = new WriterThread(this);
+    m_writerThread->start();
+
+    const int workers = qMin(m_threadCount,
+                             (m_frameCount - start + m_blockSize - 1) / m_blockSize);
+    // One slot per in-flight block: every worker's scratch block plus the
+    // writer-side queue, with a little slack.
+    const quint16 protoWidth = haveReader ? m_reader->frameHeader(0).width
+                                          : m_geomWidth;
+    const quint16 protoHeight = haveReader ? m_reader->frameHeader(0).height
+                                           : m_geomHeight;
+    const qint64 blockBytes = qint64(m_blockSize) * protoWidth * protoHeight
+            * qint64(sizeof(quint16));
+    if (m_budget) {
+        // Decoded blocks dominate the footprint, so the pool takes the
+        // bulk of the budget; whatever exceeds the workers' scratch slots
+        // becomes writer-queue depth. With a slow target disk the queue
+        // fills, the pool drains, and workers block in acquire() — the
+        // budget holds no matter how far the writer lags. The queue floor
+        // is one slot per worker: any less and every worker finishing
+        // ahead of the in-order one would park on a full queue, so a
+        // starved budget would stall instead of merely slowing down.
+        const int scratch = qMax(1, workers) + 2;
+        // The ceiling tracks the floor on many-core machines; qBound
+        // requires min <= max.
+        const int slots = m_budget->unitsFor(blockBytes, 0.75,
+                                             scratch + qMax(1, workers),
+                                             scratch + qMax(18, workers));
+        m_queueLimit = qMax(qMax(1, workers), slots - scratch);
+        m_pool.configure(blockBytes, slots);
+    } else {
+        m_queueLimit = 8;
+        m_pool.configure(blockBytes, qMax(1, workers) + m_queueLimit + 2);
+    }
+    m_workersLeft.storeRelease(qMax(1, workers));
+    m_decodePool.setMaxThreadCount(qMax(1, workers));
+    for (int i = 0; i < qMax(1, workers); ++i)
+        m_decodePool.start(new DecodeRangeTask(this));
+}
+
+void ConversionPipeline::cancel()
+{
+    m_cancelled.storeRelease(1);
+    m_queueNotFull.wakeAll();
+    m_queueNotEmpty.wakeAll();
+    m_moreInput.wakeAll();
+}
+
+bool ConversionPipeline::claimBlock(int *firstFrame, int *frameCount)
+{
+    if (!m_liveMode) {
+        if (m_cancelled.loadAcquire())
+            return false;
+        const int first = m_nextFrame.fetchAndAddOrdered(m_blockSize);
+        if (first >= m_frameCount)
+            return false;
+        *firstFrame = first;
+        *frameCount = qMin(m_blockSize, m_frameCount - first);
+        return true;
+    }
+    // Live mode: only full blocks are claimed while the file is growing, so
+    // every chunk except the very last stays aligned; the tail is released
+    // by finishInput().
+    QMutexLocker locker(&m_liveMutex);
+    for (;;) {
+        if (m_cancelled.loadAcquire())
+            return false;
+        if (m_liveCursor + m_blockSize <= m_liveAvailable
+                || (m_inputDone && m_liveCursor < m_liveAvailable)) {
+            *firstFrame = m_liveCursor;
+            *frameCount = qMin(m_blockSize, m_liveAvailable - m_liveCursor);
+            m_liveCursor += *frameCount;
+            return true;
+        }
+        if (m_inputDone)
+            return false;
+        m_moreInput.wait(&m_liveMutex, 100);
+    }
+}
+
+void ConversionPipeline::decodeBlock(int firstFrame, int frameCount)
+{
+    DecodedBlock block;
+    block.firstFrame = firstFrame;
+    block.frameCount = frameCount;
+    if (m_frameSource) {
+        block.width = m_geomWidth;
+        block.height = m_geomHeight;
+    } else {
+        const MibFrameHeader &proto = m_reader->frameHeader(firstFrame);
+        block.width = proto.width;
+        block.height = proto.height;
+    }
+    const qint64 frameSize = qint64(block.width) * block.height;
+    block.poolSlot = m_pool.acquire();
+    block.pixels = m_pool.slotData(block.poolSlot);
+    block.pixelCount = frameSize * frameCount;
+
+    ScopedStageTimer timer;
+    qint64 packedBytes = 0;
+    MibDecode::FrameDecoder decoder = m_decoder;
+    for (int i = 0; i < frameCount; ++i) {
+        if (m_cancelled.loadAcquire()) {
+            m_pool.release(block.poolSlot);
+            return;
+        }
+        const MibFrameView view = m_frameSource ? m_frameSource(firstFrame + i)
+                                                : m_reader->frame(firstFrame + i);
+        packedBytes += view.size;
+        if (!decoder)
+            decoder = MibDecode::select(view.header.counterDepth,
+                                        view.header.rawMode);
+        decoder(view, block.pixels + frameSize * i);
+        if (m_frameRelease)
+            m_frameRelease(firstFrame + i);
+        if (m_corrector)
+            m_corrector->correctFrame(block.pixels + frameSize * i);
+    }
+    timer.commit(m_profiler, PipelineProfiler::DecodeStage,
+                 packedBytes, block.pixelCount * qint64(sizeof(quint16)));
+    // The reductions ride the same pass while the block is still hot in
+    // cache, instead of rereading the output afterwards.
+    if (m_stats)
+        m_stats->accumulateBlock(block);
+    enqueueBlock(std::move(block));
+
+    const int done = m_framesDone.fetchAndAddOrdered(frameCount) + frameCount;
+    // Throttle progress traffic: one queued signal per block is plenty for
+    // the GUI.
+    emit progressChanged(done, m_frameCount);
+}
+
+void ConversionPipeline::enqueueBlock(DecodedBlock &&block)
+{
+    QMutexLocker locker(&m_queueMutex);
+    // The next-in-order block is exempt from the limit: the writer only
+    // ever removes m_nextToWrite, so parking that block's worker here
+    // while later blocks fill the queue would deadlock the run. The
+    // writer's take wakes the waiters, so the check follows every advance
+    // of m_nextToWrite.
+    while (m_pending.size() >= m_queueLimit
+           && block.firstFrame != m_nextToWrite
+           && !m_cancelled.loadAcquire()) {
+        m_queueNotFull.wait(&m_queueMutex);
+    }
+    if (m_cancelled.loadAcquire()) {
+        m_pool.release(block.poolSlot);
+        return;
+    }
+    m_pending.insert(block.firstFrame, std::move(block));
+    if (m_profiler)
+        m_profiler->recordQueueDepth(PipelineProfiler::WriteStage, m_pending.size());
+    m_queueNotEmpty.wakeAll();
+}
+
+void ConversionPipeline::drainQueue()
+{
+    for (;;) {
+        DecodedBlock block;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            while (!m_pending.contains(m_nextToWrite)
+                   && !m_cancelled.loadAcquire()
+                   && !(m_workersLeft.loadAcquire() == 0 && m_pending.isEmpty())) {
+                m_queueNotEmpty.wait(&m_queueMutex, 100);
+            }
+            if (m_pending.contains(m_nextToWrite)) {
+                block = m_pending.take(m_nextToWrite);
+                m_queueNotFull.wakeAll();
+            } else if (m_cancelled.loadAcquire()
+                       || (m_workersLeft.loadAcquire() == 0 && m_pending.isEmpty())) {
+                break;
+            } else {
+                continue;
+            }
+        }
+        const bool sinkOk = !m_sink || m_sink(block);
+        m_pool.release(block.poolSlot);
+        if (!sinkOk) {
+            m_writerFailed = true;
+            m_cancelled.storeRelease(1);
+            m_queueNotFull.wakeAll();
+            break;
+        }
+        {
+            // Published under the queue mutex with a wake so a parked
+            // worker re-evaluates its in-order exemption right away.
+            QMutexLocker locker(&m_queueMutex);
+            m_nextToWrite = block.firstFrame + block.frameCount;
+            m_queueNotFull.wakeAll();
+        }
+    }
+    // Return any blocks stranded by a cancel or writer failure to the pool.
+    {
+        QMutexLocker locker(&m_queueMutex);
+        for (const DecodedBlock &block : m_pending)
+            m_pool.release(block.poolSlot);
+        m_pending.clear();
+    }
+    const bool success = !m_cancelled.loadAcquire() && !m_writerFailed
+            && m_framesDone.loadAcquire() == m_frameCount;
+    m_running.storeRelease(0);
+    if (m_writerFailed)
+        emit errorOccurred(QStringLiteral("Writer stage failed"));
+    emit finished(success);
+}
+
+void ConversionPipeline::workerFinished()
+{
+    m_workersLeft.fetchAndSubOrdered(1);
+    m_queueNotEmpty.wakeAll();
+}
@@ -0,0 +1,201 @@
+#ifndef CONVERSIONPIPELINE_H
+#define CONVERSIONPIPELINE_H
+
+#include <QObject>
+#include <QMap>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+#include <QAtomicInt>
+
+#include <functional>
+
+#include "decodekernels.h"
+#include "framebufferpool.h"
+#include "mibreader.h"
+#include "pipelineprofiler.h"
+
+class MemoryBudget;
+class PixelCorrector;
+class StreamingStats;
+
+//! A contiguous run of decoded frames on its way from the decode workers to
+//! the writer thread. Pixels are stored frame-major as unpacked uint16 in a
+//! buffer-pool slot; the pipeline releases the slot after the sink returns.
+struct DecodedBlock
+{
+    int firstFrame = 0;
+    int frameCount = 0;
+    quint16 width = 0;
+    quint16 height = 0;
+    quint16 *pixels = nullptr;
+    qint64 pixelCount = 0;
+    int poolSlot = -1;  //!< Arena slot, -1 for externally owned storage.
+};
+
+//! Multithreaded decode pipeline over a memory-mapped .mib file.
+//!
+//! The frame range is split into contiguous blocks which N workers on a
+//! pipeline-owned QThreadPool claim from a shared atomic cursor (idle
+//! workers steal the next block, so uneven decode costs balance out; the
+//! owned pool lets teardown join them). Decoded blocks are
+//! handed to a single writer thread through a bounded queue. The GUI only
+//! ever sees the aggregated progressChanged()/finished() signals, emitted
+//! across threads via queued connections.
+class ConversionPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    //! Sink invoked on the writer thread for each decoded block, in frame
+    //! order. Replaceable so the output stage can evolve independently.
+    using BlockSink = std::function<bool(const DecodedBlock &)>;
+
+    //! Alternative frame input for front-ends that do not go through a
+    //! mapped file (e.g. the Merlin socket capture): the source hands out a
+    //! view of frame \a index, the release hook is called once the frame has
+    //! been decoded and its buffer may be recycled.
+    using FrameSource = std::function<MibFrameView(int)>;
+    using FrameRelease = std::function<void(int)>;
+
+    explicit ConversionPipeline(QObject *parent = nullptr);
+    ~ConversionPipeline();
+
+    void setReader(MibReader *reader) { m_reader = reader; }
+    void setBlockSink(BlockSink sink) { m_sink = std::move(sink); }
+    //! Replaces the reader as the frame input; clear with empty functions to
+    //! return to file mode. Requires setFrameGeometry() and, since the
+    //! source has no intrinsic length, setExpectedFrames().
+    void setFrameSource(FrameSource source, FrameRelease release)
+    {
+        m_frameSource = std::move(source);
+        m_frameRelease = std::move(release);
+    }
+    //! Frame geometry when no reader is attached.
+    void setFrameGeometry(quint16 width, quint16 height)
+    {
+        m_geomWidth = width;
+        m_geomHeight = height;
+    }
+    //! Optional; decode timing and writer-queue depth are recorded when set.
+    void setProfiler(PipelineProfiler *profiler) { m_profiler = profiler; }
+    //! Optional; the block pool and writer-queue depth are sized from the
+    //! shared byte budget instead of the fixed defaults, capping peak
+    //! memory regardless of input size or target disk speed.
+    void setMemoryBudget(const MemoryBudget *budget) { m_budget = budget; }
+    //! Optional; each decoded block is folded into the reductions on its
+    //! decode worker before it is queued for writing. Configure the stats
+    //! object (begin(), mask) before start().
+    void setStatistics(StreamingStats *stats) { m_stats = stats; }
+    //! Optional; each frame is defect-corrected right after decode, before
+    //! the reductions and the writer see it. The corrector must be
+    //! prepare()d for the frame geometry before start().
+    void setPixelCorrector(const PixelCorrector *corrector) { m_corrector = corrector; }
+
+    //! Frames per decode block; larger blocks amortize queue traffic, smaller
+    //! ones balance better. Default 64.
+    void setBlockSize(int frames);
+    //! Worker count; defaults to QThread::idealThreadCount().
+    void setThreadCount(int threads);
+    //! First frame to decode; a resumed conversion passes the writer's
+    //! resume frame so the durable prefix is never re-decoded. The reader's
+    //! header index makes the seek free. Default 0.
+    void setStartFrame(int frame);
+
+    //! Live mode: the reader is tailing a growing file, so workers claim
+    //! only full blocks below the frontier published via extendTo() and wait
+    //! for more input instead of finishing. finishInput() releases them once
+    //! the acquisition is over.
+    void setLiveMode(bool live);
+    //! Expected frame total (from the companion .hdr) for progress reporting
+    //! while the file is still growing.
+    void setExpectedFrames(int frames);
+    //! Publishes that frames [0, \a frames) are now complete on disk.
+    void extendTo(int frames);
+    //! Declares the input finished; the partial tail block is flushed and
+    //! the run winds down. No-op outside live mode.
+    void finishInput();
+
+    bool isRunning() const { return m_running.loadAcquire() != 0; }
+
+public slots:
+    //! Starts converting all frames of the current reader. No-op if a run is
+    //! already in flight.
+    void start();
+    //! Requests a cooperative stop; finished(false) is emitted once the
+    //! workers have drained.
+    void cancel();
+
+signals:
+    void progressChanged(int framesDone, int framesTotal);
+    void finished(bool success);
+    void errorOccurred(const QString &message);
+
+private:
+    friend class DecodeRangeTask;
+    friend class WriterThread;
+
+    //! Claims the next block of frames; returns false when the file is
+    //! exhausted or the run was cancelled.
+    bool claimBlock(int *firstFrame, int *frameCount);
+    //! Decodes one claimed block and queues it for the writer.
+    void decodeBlock(int firstFrame, int frameCount);
+    void enqueueBlock(DecodedBlock &&block);
+    //! Writer-thread loop body: pops blocks in order and feeds the sink.
+    void drainQueue();
+    void workerFinished();
+
+    MibReader *m_reader = nullptr;
+    BlockSink m_sink;
+    FrameSource m_frameSource;
+    FrameRelease m_frameRelease;
+    quint16 m_geomWidth = 0;
+    quint16 m_geomHeight = 0;
+    //! Specialized decode kernel, dispatched once per file in start().
+    MibDecode::FrameDecoder m_decoder = nullptr;
+    int m_blockSize = 64;
+    int m_threadCount = 0;
+    int m_startFrame = 0;
+    bool m_liveMode = false;
+    int m_expectedFrames = 0;
+
+    // Live-mode frontier; claims fall back to a mutex here because the
+    // atomic cursor cannot wait for input.
+    QMutex m_liveMutex;
+    QWaitCondition m_moreInput;
+    int m_liveCursor = 0;
+    int m_liveAvailable = 0;
+    bool m_inputDone = true;
+    //! Recycles block buffers decode→write with zero steady-state heap
+    //! allocations; sized in start() for the in-flight block count.
+    FrameBufferPool m_pool;
+    //! Pipeline-owned so the destructor can waitForDone() on the decode
+    //! workers; tasks on the global pool would outlive the pipeline.
+    QThreadPool m_decodePool;
+    const MemoryBudget *m_budget = nullptr;
+    PipelineProfiler *m_profiler = nullptr;
+    StreamingStats *m_stats = nullptr;
+    const PixelCorrector *m_corrector = nullptr;
+
+    QAtomicInt m_running;
+    QAtomicInt m_cancelled;
+    QAtomicInt m_nextFrame;
+    QAtomicInt m_framesDone;
+    QAtomicInt m_workersLeft;
+    int m_frameCount = 0;
+
+    // Writer-side state: blocks may finish out of order, so they are parked
+    // here until the next-in-order block is available.
+    QMutex m_queueMutex;
+    QWaitCondition m_queueNotEmpty;
+    QWaitCondition m_queueNotFull;
+    QMap<int, DecodedBlock> m_pending; // keyed by firstFrame
+    int m_nextToWrite = 0;
+    int m_queueLimit = 8;
+    bool m_writerFailed = false;
+    QThread *m_writerThread = nullptr;
+};
+
+#endif // CONVERSIONPIPELINE_H
@@ -0,0 +1,152 @@
+#include "decodekernels.h"
+#include "bitunpack.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+namespace MibDecode {
+
+namespace {
+
+// One instantiation per (depth, mode) pair. The primary template is never
+// defined: asking for an unsupported combination is a compile error, and
+// runtime dispatch falls back to zeroFill() instead.
+template <int Depth, bool RawMode>
+struct FrameKernel;
+
+// Processed-mode payloads hold one little-endian value per pixel; the
+// kernels widen (and for 24-bit counters stored as U32, clamp) into the
+// uint16 stream with a constant stride the compiler can unroll.
+template <>
+struct FrameKernel<8, false>
+{
+    static void decode(const MibFrameView &view, quint16 *dst)
+    {
+        const qint64 pixels = qint64(view.header.width) * view.header.height;
+        const quint8 *src = view.data;
+        for (qint64 i = 0; i < pixels; ++i)
+            dst[i] = src[i];
+    }
+};
+
+template <>
+struct FrameKernel<16, false>
+{
+    static void decode(const MibFrameView &view, quint16 *dst)
+    {
+        const qint64 pixels = qint64(view.header.width) * view.header.height;
+        const quint16 *src = reinterpret_cast<const quint16 *>(view.data);
+        for (qint64 i = 0; i < pixels; ++i)
+            dst[i] = qFromLittleEndian(src[i]);
+    }
+};
+
+template <>
+struct FrameKernel<32, false>
+{
+    static void decode(const MibFrameView &view, quint16 *dst)
+    {
+        const qint64 pixels = qint64(view.header.width) * view.header.height;
+        const quint32 *src = reinterpret_cast<const quint32 *>(view.data);
+        for (qint64 i = 0; i < pixels; ++i) {
+            const quint32 v = qFromLittleEndian(src[i]);
+            dst[i] = v > 0xFFFF ? 0xFFFF : quint16(v);
+        }
+    }
+};
+
+// Raw-mode kernels walk the packed rows with a row stride that is a
+// compile-time function of the depth, handing each row to the vectorized
+// unpack kernel for that exact width.
+template <>
+struct FrameKernel<1, true>
+{
+    static void decode(const MibFrameView &view, quint16 *dst)
+    {
+        const int width = view.header.width;
+        const qint64 rowBytes = MibUnpack::packedRowBytes(width, 1);
+        for (int y = 0; y < view.header.height; ++y)
+            MibUnpack::unpackRow1(view.data + y * rowBytes,
+                                  dst + qint64(y) * width, width);
+    }
+};
+
+template <>
+struct FrameKernel<6, true>
+{
+    static void decode(const MibFrameView &view, quint16 *dst)
+    {
+        const int width = view.header.width;
+        const qint64 rowBytes = MibUnpack::packedRowBytes(width, 6);
+        for (int y = 0; y < view.header.height; ++y)
+            MibUnpack::unpackRow6(view.data + y * rowBytes,
+                                  dst + qint64(y) * width, width);
+    }
+};
+
+template <>
+struct FrameKernel<12, true>
+{
+    static void decode(const MibFrameView &view, quint16 *dst)
+    {
+        const int width = view.header.width;
+        const qint64 rowBytes = MibUnpack::packedRowBytes(width, 12);
+        for (int y = 0; y < view.header.height; ++y)
+            MibUnpack::unpackRow12(view.data + y * rowBytes,
+                                   dst + qint64(y) * width, width);
+    }
+};
+
+template <>
+struct FrameKernel<24, true>
+{
+    static void decode(const MibFrameView &view, quint16 *dst)
+    {
+        // Clamp into the uint16 stream row by row through a small staging
+        // buffer on the stack, as in MibUnpack::unpackFrameU16().
+        const int width = view.header.width;
+        const qint64 rowBytes = MibUnpack::packedRowBytes(width, 24);
+        for (int y = 0; y < view.header.height; ++y) {
+            quint32 staging[1024];
+            const quint8 *row = view.data + y * rowBytes;
+            quint16 *out = dst + qint64(y) * width;
+            for (int x0 = 0; x0 < width; x0 += 1024) {
+                const int n = qMin(1024, width - x0);
+                MibUnpack::unpackRow24(row + qint64(x0) * 3, staging, n);
+                for (int i = 0; i < n; ++i)
+                    out[x0 + i] = staging[i] > 0xFFFF ? 0xFFFF
+                                                      : quint16(staging[i]);
+            }
+        }
+    }
+};
+
+void zeroFill(const MibFrameView &view, quint16 *dst)
+{
+    const qint64 pixels = qint64(view.header.width) * view.header.height;
+    memset(dst, 0, pixels * sizeof(quint16));
+}
+
+} // namespace
+
+FrameDecoder select(int counterDepth, bool rawMode)
+{
+    if (rawMode) {
+        switch (counterDepth) {
+        case 1:  return FrameKernel<1, true>::decode;
+        case 6:  return FrameKernel<6, true>::decode;
+        case 12: return FrameKernel<12, true>::decode;
+        case 24: return FrameKernel<24, true>::decode;
+        }
+    } else {
+        switch (counterDepth) {
+        case 8:  return FrameKernel<8, false>::decode;
+        case 16: return FrameKernel<16, false>::decode;
+        case 32: return FrameKernel<32, false>::decode;
+        }
+    }
+    return zeroFill;
+}
+
+} // namespace MibDecode
@@ -0,0 +1,26 @@
+#ifndef DECODEKERNELS_H
+#define DECODEKERNELS_H
+
+#include "mibreader.h"
+
+//! Compile-time specialized frame decode kernels.
+//!
+//! The counter depth and raw/processed mode are fixed for a whole
+//! acquisition, so instead of one generic loop that re-checks them, each
+//! (depth, mode) pair gets its own template instantiation with constant
+//! strides and branch-free, unrollable inner loops. select() resolves the
+//! kernel once per file; after that the pipeline calls straight through a
+//! function pointer.
+namespace MibDecode {
+
+//! Decodes one frame's payload into an unpacked uint16 scanline buffer.
+using FrameDecoder = void (*)(const MibFrameView &view, quint16 *dst);
+
+//! Returns the specialized kernel for \a counterDepth (payload bits in
+//! processed mode, counter bits in raw mode). Unsupported combinations get
+//! a zero-fill kernel so callers never need a fallback branch.
+FrameDecoder select(int counterDepth, bool rawMode);
+
+} // namespace MibDecode
+
+#endif // DECODEKERNELS_H
@@ -0,0 +1,141 @@
+#include "framebrowser.h"
+#include "glframeview.h"
+
+#include <QLabel>
+#include <QOpenGLContext>
+#include <QPixmap>
+
+namespace {
+
+//! The detail view's R16UI texture and integer-sampler shader need a GL 3
+//! context; probed once, because context creation is not free.
+bool glDetailSupported()
+{
+    static int supported = -1;
+    if (supported < 0) {
+        QOpenGLContext probe;
+        supported = probe.create() && probe.format().majorVersion() >= 3
+                ? 1 : 0;
+    }
+    return supported == 1;
+}
+
+} // namespace
+
+FrameBrowserModel::FrameBrowserModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void FrameBrowserModel::setReader(MibReader *reader)
+{
+    beginResetModel();
+    m_reader = reader;
+    m_previews.setReader(reader);
+    m_frames.setReader(reader);
+    m_previews.clear();
+    endResetModel();
+}
+
+int FrameBrowserModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !m_reader || !m_reader->isOpen())
+        return 0;
+    return m_reader->frameCount();
+}
+
+QVariant FrameBrowserModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || !m_reader)
+        return QVariant();
+    switch (role) {
+    case Qt::DisplayRole:
+        return tr("Frame %1").arg(index.row());
+    case Qt::DecorationRole: {
+        // Only reached for rows inside the viewport: this is where the
+        // lazy decode happens.
+        const BinnedFrame *binned = m_previews.binned(index.row(), 8);
+        if (!binned)
+            return QVariant();
+        return QPixmap::fromImage(PreviewEngine::toImage(*binned));
+    }
+    case Qt::ToolTipRole: {
+        const MibFrameHeader &header = m_reader->frameHeader(index.row());
+        return tr("Frame %1 — %2x%3, %4 bit, %5 s")
+                .arg(header.frameNumber).arg(header.width).arg(header.height)
+                .arg(header.counterDepth).arg(header.exposure);
+    }
+    default:
+        return QVariant();
+    }
+}
+
+FrameBrowser::FrameBrowser(QWidget *parent)
+    : QListView(parent)
+    , m_model(new FrameBrowserModel(this))
+{
+    setModel(m_model);
+    setViewMode(QListView::IconMode);
+    setResizeMode(QListView::Adjust);
+    setLayoutMode(QListView::Batched);
+    // Uniform sizes let the view lay out 65k rows without measuring each
+    // delegate, which is what makes the scrolling "virtual".
+    setUniformItemSizes(true);
+    setIconSize(QSize(64, 64));
+    connect(this, &QListView::activated,
+            this, &FrameBrowser::showFrameDetail);
+}
+
+void FrameBrowser::setReader(MibReader *reader)
+{
+    m_reader = reader;
+    m_model->setReader(reader);
+}
+
+void FrameBrowser::showFrameDetail(const QModelIndex &index)
+{
+    if (!m_reader || !m_reader->isOpen())
+        return;
+    const QVector<quint16> *pixels = m_model->fullFrame(index.row());
+    if (!pixels)
+        return;
+    const MibFrameHeader &header = m_reader->frameHeader(index.row());
+    if (glDetailSupported()) {
+        if (!m_detailView) {
+            m_detailView = new GLFrameView(this);
+            m_detailView->setWindowFlags(Qt::Window);
+            m_detailView->resize(512, 512);
+        }
+        // Map the counter's full range onto the display; 24-bit counts are
+        // clamped to uint16 by the decode kernel already.
+        const float peak = header.counterDepth >= 16
+                ? 65535.0f : float((1 << header.counterDepth) - 1);
+        m_detailView->setDisplayRange(0.0f, peak);
+        m_detailView->setWindowTitle(tr("Frame %1").arg(index.row()));
+        m_detailView->setFrame(pixels->constData(), header.width, header.height);
+        m_detailView->show();
+        m_detailView->raise();
+        return;
+    }
+    // CPU fallback: an autoscaled 8-bit rendering, slower but dependency
+    // free.
+    if (!m_fallbackView) {
+        m_fallbackView = new QLabel(this, Qt::Window);
+        m_fallbackView->setScaledContents(true);
+        m_fallbackView->resize(512, 512);
+    }
+    quint16 peak = 1;
+    for (const quint16 value : *pixels)
+        peak = qMax(peak, value);
+    QImage image(header.width, header.height, QImage::Format_Grayscale8);
+    const quint16 *src = pixels->constData();
+    for (int y = 0; y < header.height; ++y) {
+        uchar *dst = image.scanLine(y);
+        for (int x = 0; x < header.width; ++x)
+            dst[x] = uchar((src[qint64(y) * header.width + x] * 255) / peak);
+    }
+    m_fallbackView->setWindowTitle(tr("Frame %1").arg(index.row()));
+    m_fallbackView->setPixmap(QPixmap::fromImage(image));
+    m_fallbackView->show();
+    m_fallbackView->raise();
+}
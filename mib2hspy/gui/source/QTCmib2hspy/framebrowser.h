@@ -0,0 +1,70 @@
+#ifndef FRAMEBROWSER_H
+#define FRAMEBROWSER_H
+
+#include <QAbstractListModel>
+#include <QListView>
+
+#include "framecache.h"
+#include "previewengine.h"
+
+//! List model over a .mib stack that decodes lazily.
+//!
+//! rowCount() is just the frame count from the header index; pixels are
+//! only touched when the view asks for a decoration, i.e. when a frame
+//! scrolls into the viewport. Thumbnails come from the binned preview
+//! pyramid, full frames from the LRU frame cache, so nothing is converted
+//! up front and a bad acquisition can be triaged without converting it.
+class FrameBrowserModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit FrameBrowserModel(QObject *parent = nullptr);
+
+    void setReader(MibReader *reader);
+
+    //! Budget of the decoded-frame cache in bytes.
+    void setCacheBudget(qint64 bytes) { m_frames.setBudget(bytes); }
+
+    //! Full-resolution decoded pixels for detail views; decoded on demand
+    //! through the cache.
+    const QVector<quint16> *fullFrame(int frameIndex) { return m_frames.frame(frameIndex); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+private:
+    MibReader *m_reader = nullptr;
+    mutable PreviewEngine m_previews;
+    FrameCache m_frames;
+};
+
+class GLFrameView;
+class QLabel;
+
+//! Virtual-scrolling icon view over a FrameBrowserModel.
+//!
+//! Activating a frame opens it full-resolution in the OpenGL detail view;
+//! sessions without a GL 3 context (remote desktops, software rendering)
+//! fall back to a plain scaled image window.
+class FrameBrowser : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit FrameBrowser(QWidget *parent = nullptr);
+
+    void setReader(MibReader *reader);
+    FrameBrowserModel *model() const { return m_model; }
+
+private slots:
+    void showFrameDetail(const QModelIndex &index);
+
+private:
+    FrameBrowserModel *m_model;
+    MibReader *m_reader = nullptr;
+    GLFrameView *m_detailView = nullptr;   // lazily created on activation
+    QLabel *m_fallbackView = nullptr;
+};
+
+#endif // FRAMEBROWSER_H
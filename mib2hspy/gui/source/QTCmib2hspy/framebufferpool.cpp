@@ -0,0 +1,80 @@
+#include "framebufferpool.h"
+
+#include <limits>
+
+FrameBufferPool::FrameBufferPool()
+    : m_head(0)
+{
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+}
+
+void FrameBufferPool::configure(qint64 slotBytes, int slotCount)
+{
+    // A single arena would cap the pool at QByteArray's 2 GiB ceiling —
+    // silently, since Qt5's resize() takes an int — so each slot gets its
+    // own buffer. A lone slot still has to fit.
+    Q_ASSERT(slotBytes <= qint64(std::numeric_limits<int>::max()));
+    m_slotBytes = slotBytes;
+    m_slotCount = slotCount;
+    m_slots.resize(slotCount);
+    for (int i = 0; i < slotCount; ++i)
+        m_slots[i].resize(int(slotBytes));
+    m_next.resize(slotCount);
+    m_head.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < slotCount; ++i)
+        push(i);
+    m_available.reset(new QSemaphore(slotCount));
+}
+
+int FrameBufferPool::acquire()
+{
+    // The semaphore guarantees the freelist is non-empty once we pass it.
+    m_available->acquire();
+    return pop();
+}
+
+bool FrameBufferPool::tryAcquire(int *slot)
+{
+    if (!m_available || !m_available->tryAcquire())
+        return false;
+    *slot = pop();
+    return true;
+}
+
+void FrameBufferPool::release(int slot)
+{
+    push(slot);
+    m_available->release();
+}
+
+void FrameBufferPool::push(int slot)
+{
+    quint64 oldHead = m_head.load(std::memory_order_acquire);
+    for (;;) {
+        m_next[slot] = quint32(oldHead & 0xFFFFFFFFu);
+        const quint64 newHead = ((oldHead >> 32) + 1) << 32 | quint64(slot + 1);
+        if (m_head.compare_exchange_weak(oldHead, newHead,
+                                         std::memory_order_release,
+                                         std::memory_order_acquire))
+            return;
+    }
+}
+
+int FrameBufferPool::pop()
+{
+    quint64 oldHead = m_head.load(std::memory_order_acquire);
+    for (;;) {
+        const int slot = int(oldHead & 0xFFFFFFFFu) - 1;
+        // The slot's next pointer may be stale if another thread races us,
+        // but the tag in the upper word makes the CAS fail in that case.
+        const quint64 newHead = ((oldHead >> 32) + 1) << 32
+                | quint64(m_next[slot]);
+        if (m_head.compare_exchange_weak(oldHead, newHead,
+                                         std::memory_order_release,
+                                         std::memory_order_acquire))
+            return slot;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef FRAMEBUFFERPOOL_H
+#define FRAMEBUFFERPOOL_H
+
+#include <QByteArray>
+#include <QScopedPointer>
+#include <QSemaphore>
+#include <QVector>
+
+#include <atomic>
+
+//! Pool of fixed-size frame-block buffers with a lock-free freelist.
+//!
+//! At 65k frames per stack, a heap allocation per decoded block would
+//! serialize the workers on the allocator lock and fragment the heap; here
+//! every slot is allocated once at start() time (one buffer per slot — the
+//! aggregate can exceed QByteArray's 2 GiB ceiling on large budgets) and
+//! recycled through a tagged Treiber stack (the tag defeats ABA), so the
+//! steady-state decode→write path does zero heap allocations. A semaphore
+//! tracks slot availability so acquire() can wait without spinning when the
+//! writer lags.
+class FrameBufferPool
+{
+public:
+    FrameBufferPool();
+    ~FrameBufferPool();
+
+    FrameBufferPool(const FrameBufferPool &) = delete;
+    FrameBufferPool &operator=(const FrameBufferPool &) = delete;
+
+    //! (Re)allocates the arena: \a slotCount buffers of \a slotBytes each.
+    //! Only valid while no slot is held.
+    void configure(qint64 slotBytes, int slotCount);
+
+    //! Blocks until a slot is free and returns its index. Lock-free except
+    //! for the semaphore wait when the pool is exhausted.
+    int acquire();
+    //! Non-blocking variant for callers that must not stall (e.g. a socket
+    //! reader applying backpressure instead); returns false when exhausted.
+    bool tryAcquire(int *slot);
+    //! Returns \a slot to the freelist.
+    void release(int slot);
+
+    quint16 *slotData(int slot) { return reinterpret_cast<quint16 *>(m_slots[slot].data()); }
+    qint64 slotBytes() const { return m_slotBytes; }
+    int slotCount() const { return m_slotCount; }
+
+private:
+    void push(int slot);
+    int pop();
+
+    QVector<QByteArray> m_slots;
+    qint64 m_slotBytes = 0;
+    int m_slotCount = 0;
+    //! Freelist head: (tag << 32) | (slot index + 1); 0 in the low word
+    //! means empty (never observed thanks to the semaphore).
+    std::atomic<quint64> m_head;
+    QVector<quint32> m_next;    //!< Per-slot successor (index + 1).
+    QScopedPointer<QSemaphore> m_available;
+};
+
+#endif // FRAMEBUFFERPOOL_H
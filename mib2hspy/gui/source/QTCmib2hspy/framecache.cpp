@@ -0,0 +1,59 @@
+#include "framecache.h"
+#include "bitunpack.h"
+
+#include <climits>
+#include <cstring>
+
+FrameCache::FrameCache()
+{
+    setBudget(2 * qint64(1024) * 1024 * 1024);
+}
+
+void FrameCache::setReader(MibReader *reader)
+{
+    m_reader = reader;
+    m_cache.clear();
+}
+
+void FrameCache::setBudget(qint64 bytes)
+{
+    // QCache costs are ints; account in kB so multi-GB budgets fit.
+    m_cache.setMaxCost(int(qMin<qint64>(bytes / 1024, INT_MAX)));
+}
+
+const QVector<quint16> *FrameCache::frame(int frameIndex)
+{
+    if (const QVector<quint16> *cached = m_cache.object(frameIndex))
+        return cached;
+    if (!m_reader || !m_reader->isOpen())
+        return nullptr;
+    const MibFrameView view = m_reader->frame(frameIndex);
+    if (!view.isValid())
+        return nullptr;
+
+    const int width = view.header.width;
+    const int height = view.header.height;
+    QVector<quint16> *decoded = new QVector<quint16>(width * height);
+    bool ok = true;
+    if (view.header.rawMode) {
+        ok = MibUnpack::unpackFrameU16(view.data, decoded->data(),
+                                       width, height, view.header.counterDepth);
+    } else if (view.header.counterDepth == 16) {
+        memcpy(decoded->data(), view.data, size_t(decoded->size()) * sizeof(quint16));
+    } else {
+        const quint8 *src = view.data;
+        const int bytes = view.header.counterDepth / 8;
+        for (int i = 0; i < decoded->size(); ++i) {
+            quint32 v = 0;
+            memcpy(&v, src + qint64(i) * bytes, size_t(bytes));
+            (*decoded)[i] = v > 0xFFFF ? 0xFFFF : quint16(v);
+        }
+    }
+    if (!ok) {
+        delete decoded;
+        return nullptr;
+    }
+    const int cost = qMax(1, int(qint64(decoded->size()) * 2 / 1024));
+    m_cache.insert(frameIndex, decoded, cost);
+    return decoded;
+}
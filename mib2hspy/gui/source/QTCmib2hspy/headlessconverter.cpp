@@ -0,0 +1,370 @@
+#include "headlessconverter.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QObject>
+
+#include <cstdio>
+
+#include "conversionpipeline.h"
+#include "hdrparser.h"
+#include "hspywriter.h"
+#include "memorybudget.h"
+#include "mibfileset.h"
+#include "pixelcorrector.h"
+#include "quicklook.h"
+#include "reshapemapper.h"
+#include "streamingstats.h"
+#include "vdsmerge.h"
+
+namespace {
+
+//! Sibling of \a fileName with \a suffix in place of the extension. A plain
+//! QString::replace would also rewrite a matching substring in a directory
+//! name (think /data/runs.mib_2026/scan.mib).
+QString siblingFile(const QString &fileName, const QString &suffix)
+{
+    const QFileInfo info(fileName);
+    return info.path() + QLatin1Char('/') + info.completeBaseName() + suffix;
+}
+
+} // namespace
+
+int runHeadlessConversion(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("mib2hspy"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                QStringLiteral("Headless .mib to .hspy conversion"));
+    parser.addHelpOption();
+    const QCommandLineOption inputOption(
+                QStringList() << QStringLiteral("i") << QStringLiteral("input"),
+                QStringLiteral("Input .mib file; repeat for a chained "
+                               "acquisition split across files, merged in "
+                               "the given order"),
+                QStringLiteral("file"));
+    const QCommandLineOption outputOption(
+                QStringList() << QStringLiteral("o") << QStringLiteral("output"),
+                QStringLiteral("Output .hspy file (default: input with .hspy suffix)"),
+                QStringLiteral("file"));
+    const QCommandLineOption threadsOption(
+                QStringLiteral("threads"),
+                QStringLiteral("Decode worker count (default: all cores)"),
+                QStringLiteral("n"));
+    const QCommandLineOption codecOption(
+                QStringLiteral("codec"),
+                QStringLiteral("Chunk codec: deflate, zstd or lz4 (default deflate)"),
+                QStringLiteral("name"), QStringLiteral("deflate"));
+    const QCommandLineOption levelOption(
+                QStringLiteral("level"),
+                QStringLiteral("Compression level, 0 disables (default 1)"),
+                QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption scanSizeOption(
+                QStringLiteral("scan-size"),
+                QStringLiteral("Reshape to scan grid, e.g. 256x256"),
+                QStringLiteral("COLSxROWS"));
+    const QCommandLineOption flybackOption(
+                QStringLiteral("flyback"),
+                QStringLiteral("Flyback frames dropped per scan line (default 0)"),
+                QStringLiteral("n"), QStringLiteral("0"));
+    parser.addOption(inputOption);
+    parser.addOption(outputOption);
+    parser.addOption(threadsOption);
+    parser.addOption(codecOption);
+    parser.addOption(levelOption);
+    const QCommandLineOption vbfOption(
+                QStringLiteral("vbf"),
+                QStringLiteral("Virtual bright-field disk, e.g. 128,128,32 "
+                               "(default: centered, radius width/8)"),
+                QStringLiteral("CX,CY,R"));
+    const QCommandLineOption pixelMaskOption(
+                QStringLiteral("pixel-mask"),
+                QStringLiteral("Defect list ('x y' per line); bad pixels are "
+                               "replaced by neighbor medians"),
+                QStringLiteral("file"));
+    parser.addOption(scanSizeOption);
+    parser.addOption(flybackOption);
+    parser.addOption(vbfOption);
+    const QCommandLineOption freshOption(
+                QStringLiteral("fresh"),
+                QStringLiteral("Overwrite the output even if a checkpoint "
+                               "journal from an interrupted run exists"));
+    const QCommandLineOption quickLookOption(
+                QStringLiteral("quick-look"),
+                QStringLiteral("Also write a 2x or 4x binned quick-look "
+                               ".hspy for remote review"),
+                QStringLiteral("factor"));
+    const QCommandLineOption quickLookOnlyOption(
+                QStringLiteral("quick-look-only"),
+                QStringLiteral("Write only the quick-look output, skipping "
+                               "the full-resolution stack"));
+    parser.addOption(pixelMaskOption);
+    parser.addOption(freshOption);
+    const QCommandLineOption memoryBudgetOption(
+                QStringLiteral("memory-budget"),
+                QStringLiteral("Peak RAM for in-flight data, in MB "
+                               "(default 2048)"),
+                QStringLiteral("mb"));
+    const QCommandLineOption frameRangeOption(
+                QStringLiteral("frame-range"),
+                QStringLiteral("Convert only frames FIRST:COUNT into a part "
+                               "file; disjoint ranges on k nodes convert a "
+                               "stack k times faster"),
+                QStringLiteral("FIRST:COUNT"));
+    const QCommandLineOption mergeOption(
+                QStringLiteral("merge"),
+                QStringLiteral("Stitch part files (positional arguments, in "
+                               "frame order) into --output with an HDF5 "
+                               "virtual dataset; no pixels are copied"));
+    parser.addOption(quickLookOption);
+    parser.addOption(quickLookOnlyOption);
+    parser.addOption(memoryBudgetOption);
+    parser.addOption(frameRangeOption);
+    parser.addOption(mergeOption);
+    parser.addPositionalArgument(QStringLiteral("parts"),
+                                 QStringLiteral("Part files for --merge"),
+                                 QStringLiteral("[parts...]"));
+    parser.process(app);
+
+    if (parser.isSet(mergeOption)) {
+        const QStringList parts = parser.positionalArguments();
+        const QString mergedFile = parser.value(outputOption);
+        if (parts.isEmpty() || mergedFile.isEmpty()) {
+            fprintf(stderr, "mib2hspy: --merge needs part files and --output\n");
+            return 2;
+        }
+        QString error;
+        if (!HspyMerge::mergeParts(parts, mergedFile, &error)) {
+            fprintf(stderr, "mib2hspy: %s\n", qPrintable(error));
+            return 1;
+        }
+        return 0;
+    }
+
+    const QStringList inputFiles = parser.values(inputOption);
+    if (inputFiles.isEmpty()) {
+        fprintf(stderr, "mib2hspy: --input is required in headless mode\n");
+        return 2;
+    }
+    QString outputFile = parser.value(outputOption);
+    if (outputFile.isEmpty())
+        outputFile = siblingFile(inputFiles.first(), QStringLiteral(".hspy"));
+
+    MibFileSet reader;
+    const MedipixHdr hdr(siblingFile(inputFiles.first(),
+                                     QStringLiteral(".hdr")));
+    if (hdr.isValid() && hdr.counterDepth > 0)
+        reader.setRawCounterDepth(quint8(hdr.counterDepth));
+    if (!reader.open(inputFiles)) {
+        fprintf(stderr, "mib2hspy: %s\n", qPrintable(reader.errorString()));
+        return 1;
+    }
+
+    // Distributed mode: this invocation owns [rangeFirst, rangeFirst +
+    // rangeCount) and writes a standalone part file with part-local frame
+    // numbering; --merge stitches the parts afterwards.
+    int rangeFirst = 0;
+    int rangeCount = reader.frameCount();
+    if (parser.isSet(frameRangeOption)) {
+        const QStringList rangeParts = parser.value(frameRangeOption)
+                .split(QLatin1Char(':'));
+        rangeFirst = rangeParts.value(0).toInt();
+        rangeCount = rangeParts.size() == 2 ? rangeParts.at(1).toInt() : 0;
+        if (rangeParts.size() != 2 || rangeFirst < 0 || rangeCount <= 0
+                || rangeFirst + rangeCount > reader.frameCount()) {
+            fprintf(stderr, "mib2hspy: --frame-range expects FIRST:COUNT "
+                            "within the input (%d frames)\n",
+                    reader.frameCount());
+            return 2;
+        }
+        if (!parser.isSet(outputOption)) {
+            outputFile = siblingFile(outputFile,
+                                     QStringLiteral(".part%1.hspy")
+                                     .arg(rangeFirst));
+        }
+    }
+
+    MemoryBudget budget;
+    if (parser.isSet(memoryBudgetOption))
+        budget.setBudget(qint64(parser.value(memoryBudgetOption).toInt()) << 20);
+
+    HspyWriter writer;
+    writer.setMemoryBudget(&budget);
+    const QString codec = parser.value(codecOption).toLower();
+    HspyWriter::Codec codecId = HspyWriter::Deflate;
+    if (codec == QLatin1String("zstd"))
+        codecId = HspyWriter::Zstd;
+    else if (codec == QLatin1String("lz4"))
+        codecId = HspyWriter::LZ4;
+    else if (codec != QLatin1String("deflate")) {
+        fprintf(stderr, "mib2hspy: unknown codec '%s'\n", qPrintable(codec));
+        return 2;
+    }
+    writer.setCodec(codecId);
+    writer.setCompressionLevel(parser.value(levelOption).toInt());
+    writer.setResumable(!parser.isSet(freshOption));
+
+    const MibFrameHeader &first = reader.frameHeader(0);
+    const int chunkFrames = 64;
+    const bool quickLookOnly = parser.isSet(quickLookOnlyOption);
+    if (quickLookOnly && !parser.isSet(quickLookOption)) {
+        fprintf(stderr, "mib2hspy: --quick-look-only requires --quick-look\n");
+        return 2;
+    }
+    ScanGeometry geometry;
+    ReshapeMapper mapper;
+    const bool reshape = parser.isSet(scanSizeOption);
+    if (reshape && quickLookOnly) {
+        fprintf(stderr, "mib2hspy: --quick-look-only cannot be combined "
+                        "with --scan-size\n");
+        return 2;
+    }
+    if (reshape && parser.isSet(frameRangeOption)) {
+        fprintf(stderr, "mib2hspy: --frame-range cannot be combined with "
+                        "--scan-size; reshape the merged stack instead\n");
+        return 2;
+    }
+    if (reshape) {
+        const QStringList parts = parser.value(scanSizeOption)
+                .split(QLatin1Char('x'));
+        if (parts.size() != 2) {
+            fprintf(stderr, "mib2hspy: --scan-size expects COLSxROWS\n");
+            return 2;
+        }
+        geometry.scanCols = parts.at(0).toInt();
+        geometry.scanRows = parts.at(1).toInt();
+        geometry.flybackFrames = parser.value(flybackOption).toInt();
+        if (!writer.create4D(outputFile, geometry.scanRows, geometry.scanCols,
+                             first.width, first.height, chunkFrames)) {
+            fprintf(stderr, "mib2hspy: %s\n", qPrintable(writer.errorString()));
+            return 1;
+        }
+        mapper.begin(geometry, &writer);
+    } else if (!quickLookOnly
+               && !writer.create(outputFile, rangeCount,
+                                 first.width, first.height, chunkFrames)) {
+        fprintf(stderr, "mib2hspy: %s\n", qPrintable(writer.errorString()));
+        return 1;
+    }
+
+    QuickLookExporter quickLook;
+    if (parser.isSet(quickLookOption)) {
+        // The quick-look always starts a fresh file, but a resumed run only
+        // replays the frames after the durable prefix — the binned stack
+        // would come out silently truncated. Like the statistics, it needs
+        // a full pass.
+        if (writer.resumeFrame() > 0) {
+            fprintf(stderr, "mib2hspy: --quick-look cannot join a resumed "
+                            "run; pass --fresh or drop --quick-look\n");
+            return 2;
+        }
+        const QString quickName = siblingFile(outputFile,
+                                              QStringLiteral(".quick.hspy"));
+        quickLook.setCodec(codecId);
+        quickLook.setCompressionLevel(parser.value(levelOption).toInt());
+        if (!quickLook.begin(quickName, rangeCount,
+                             first.width, first.height,
+                             parser.value(quickLookOption).toInt(),
+                             chunkFrames)) {
+            fprintf(stderr, "mib2hspy: %s\n", qPrintable(quickLook.errorString()));
+            return 1;
+        }
+    }
+
+    StreamingStats stats;
+    stats.begin(first.width, first.height, rangeCount);
+    if (parser.isSet(vbfOption)) {
+        const QStringList parts = parser.value(vbfOption).split(QLatin1Char(','));
+        if (parts.size() != 3) {
+            fprintf(stderr, "mib2hspy: --vbf expects CX,CY,R\n");
+            return 2;
+        }
+        stats.setVirtualDisk(parts.at(0).toInt(), parts.at(1).toInt(),
+                             parts.at(2).toInt());
+    } else {
+        stats.setVirtualDisk(first.width / 2, first.height / 2,
+                             first.width / 8);
+    }
+    // A resumed run skips the durable prefix, which would leave the one-pass
+    // reductions partial; only a full pass stores them. The quick-look file
+    // carries no side datasets, so a quick-look-only run skips them too.
+    if (writer.resumeFrame() == 0 && !quickLookOnly)
+        writer.setStatistics(&stats);
+    else if (writer.resumeFrame() > 0)
+        fprintf(stderr, "mib2hspy: resuming at frame %d\n", writer.resumeFrame());
+
+    PixelCorrector corrector;
+    if (parser.isSet(pixelMaskOption)) {
+        if (!corrector.loadMask(parser.value(pixelMaskOption))) {
+            fprintf(stderr, "mib2hspy: %s\n", qPrintable(corrector.errorString()));
+            return 1;
+        }
+        corrector.prepare(first.width, first.height);
+    }
+
+    ConversionPipeline pipeline;
+    pipeline.setMemoryBudget(&budget);
+    // The file set feeds the shared decode pool through the frame-source
+    // hooks; views stay zero-copy, so no release hook is needed.
+    pipeline.setFrameSource(
+                [&reader, rangeFirst](int index) {
+        return reader.frame(rangeFirst + index);
+    }, ConversionPipeline::FrameRelease());
+    pipeline.setFrameGeometry(first.width, first.height);
+    pipeline.setExpectedFrames(rangeCount);
+    pipeline.setStartFrame(writer.resumeFrame());
+    if (writer.resumeFrame() == 0 && !quickLookOnly)
+        pipeline.setStatistics(&stats);
+    if (corrector.isReady())
+        pipeline.setPixelCorrector(&corrector);
+    pipeline.setBlockSize(chunkFrames);
+    if (parser.isSet(threadsOption))
+        pipeline.setThreadCount(parser.value(threadsOption).toInt());
+    pipeline.setBlockSink([&mapper, &writer, &quickLook, reshape,
+                           quickLookOnly](const DecodedBlock &block) {
+        if (reshape) {
+            if (!mapper.processBlock(block))
+                return false;
+        } else if (!quickLookOnly && !writer.writeBlock(block)) {
+            return false;
+        }
+        if (quickLook.isActive())
+            return quickLook.processBlock(block);
+        return true;
+    });
+
+    int lastPercent = -1;
+    QObject::connect(&pipeline, &ConversionPipeline::progressChanged,
+                     [&lastPercent](int done, int total) {
+        const int percent = total > 0 ? done * 100 / total : 0;
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            fprintf(stderr, "\rmib2hspy: %d%%", percent);
+        }
+    });
+
+    bool success = false;
+    QEventLoop loop;
+    QObject::connect(&pipeline, &ConversionPipeline::finished,
+                     [&loop, &success](bool ok) {
+        success = ok;
+        loop.quit();
+    });
+    pipeline.start();
+    loop.exec();
+    if (reshape)
+        success = mapper.finish() && success;
+    success = writer.finish() && success;
+    success = quickLook.finish() && success;
+    fprintf(stderr, "\n");
+    if (!success) {
+        fprintf(stderr, "mib2hspy: conversion failed: %s\n",
+                qPrintable(writer.errorString()));
+        return 1;
+    }
+    return 0;
+}
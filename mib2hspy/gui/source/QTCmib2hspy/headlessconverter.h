@@ -0,0 +1,13 @@
+#ifndef HEADLESSCONVERTER_H
+#define HEADLESSCONVERTER_H
+
+//! Headless (QCoreApplication) entry point for the conversion pipeline.
+//!
+//! Invoked by main() when converter arguments are present, before any
+//! QApplication — and therefore any display connection — is created, so
+//! conversions run fine on GPU-less cluster nodes under a job scheduler.
+//! Parses --input/--output/--threads/--codec/--level (plus optional
+//! --scan-size/--flyback for 4D reshape) and returns a process exit code.
+int runHeadlessConversion(int argc, char *argv[]);
+
+#endif // HEADLESSCONVERTER_H
@@ -0,0 +1,513 @@
+#include "hspywriter.h"
+#include "memorybudget.h"
+#include "streamingstats.h"
+
+#include <QRunnable>
+#include <QtEndian>
+
+#include <lz4.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Registered HDF5 filter ids (https://portal.hdfgroup.org/ filter registry);
+// the writer only stamps them into the dataset creation property list, the
+// actual encoding happens in encode() below.
+const H5Z_filter_t kDeflateFilter = H5Z_FILTER_DEFLATE;
+const H5Z_filter_t kLz4Filter = 32004;
+const H5Z_filter_t kZstdFilter = 32015;
+
+// Chunks written between barriers that may still sit in the page cache; a
+// barrier flushes the HDF5 file and syncs it to disk, making everything
+// before it durable.
+const int kChunksPerBarrier = 64;
+
+// H5Fflush only pushes HDF5's buffers into the page cache; durability needs
+// an fsync on the underlying descriptor, fished out of the sec2 driver.
+void syncToDisk(hid_t file)
+{
+    void *handle = nullptr;
+    if (H5Fget_vfd_handle(file, H5P_DEFAULT, &handle) < 0 || !handle)
+        return;
+#ifdef Q_OS_WIN
+    _commit(*static_cast<int *>(handle));
+#else
+    fsync(*static_cast<int *>(handle));
+#endif
+}
+
+// Small contiguous side dataset next to the main stack; the summary images
+// are tiny compared to the data, so no chunking or compression.
+bool writeSideDataset(hid_t group, const char *name, hid_t fileType,
+                      hid_t memType, int rank, const hsize_t *dims,
+                      const void *data)
+{
+    const hid_t space = H5Screate_simple(rank, dims, nullptr);
+    const hid_t dataset = H5Dcreate2(group, name, fileType, space,
+                                     H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    bool ok = dataset >= 0;
+    if (ok)
+        ok = H5Dwrite(dataset, memType, H5S_ALL, H5S_ALL, H5P_DEFAULT, data) >= 0;
+    if (dataset >= 0)
+        H5Dclose(dataset);
+    H5Sclose(space);
+    return ok;
+}
+
+} // namespace
+
+//! Drains compressed chunks to disk with H5Dwrite_chunk.
+class HspyIoThread : public QThread
+{
+public:
+    explicit HspyIoThread(HspyWriter *writer)
+        : m_writer(writer)
+    {
+    }
+
+protected:
+    void run() override { m_writer->ioLoop(); }
+
+private:
+    HspyWriter *m_writer;
+};
+
+//! One chunk's trip through the codec pool.
+class ChunkCompressTask : public QRunnable
+{
+public:
+    ChunkCompressTask(HspyWriter *writer, HspyWriter::PendingChunk position,
+                      QByteArray raw)
+        : m_writer(writer)
+        , m_position(std::move(position))
+        , m_raw(std::move(raw))
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override { m_writer->compressChunk(m_position, m_raw); }
+
+private:
+    HspyWriter *m_writer;
+    HspyWriter::PendingChunk m_position;
+    QByteArray m_raw;
+};
+
+HspyWriter::HspyWriter()
+{
+    setCompressionThreads(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+HspyWriter::~HspyWriter()
+{
+    finish();
+}
+
+void HspyWriter::setCompressionThreads(int threads)
+{
+    m_codecPool.setMaxThreadCount(qMax(1, threads));
+}
+
+bool HspyWriter::create(const QString &fileName, int frameCount,
+                        int width, int height, int chunkFrames)
+{
+    m_frameCount = frameCount;
+    m_width = width;
+    m_height = height;
+    m_chunkFrames = chunkFrames;
+    const hsize_t dims[3] = { hsize_t(frameCount), hsize_t(height), hsize_t(width) };
+    const hsize_t chunk[3] = { hsize_t(chunkFrames), hsize_t(height), hsize_t(width) };
+    return createDataset(fileName, dims, chunk, 3);
+}
+
+bool HspyWriter::create4D(const QString &fileName, int scanRows, int scanCols,
+                          int width, int height, int chunkCols)
+{
+    m_frameCount = scanRows * scanCols;
+    m_width = width;
+    m_height = height;
+    m_chunkFrames = chunkCols;
+    const hsize_t dims[4] = { hsize_t(scanRows), hsize_t(scanCols),
+                              hsize_t(height), hsize_t(width) };
+    const hsize_t chunk[4] = { 1, hsize_t(chunkCols),
+                               hsize_t(height), hsize_t(width) };
+    return createDataset(fileName, dims, chunk, 4);
+}
+
+bool HspyWriter::createDataset(const QString &fileName, const hsize_t *dims,
+                               const hsize_t *chunk, int rank)
+{
+    if (m_file >= 0)
+        finish();
+    m_rank = rank;
+    m_failed = false;
+    m_finishing = false;
+    m_inFlight = 0;
+    // Compressed chunks take the slice of the byte budget the decoded
+    // blocks leave; a compressed chunk is at most one raw chunk in size.
+    if (m_budget) {
+        qint64 chunkBytes = qint64(sizeof(quint16));
+        for (int i = 0; i < rank; ++i)
+            chunkBytes *= qint64(chunk[i]);
+        m_inFlightLimit = m_budget->unitsFor(chunkBytes, 0.25, 2, 32);
+    }
+    m_chunksSinceBarrier = 0;
+    m_resumeFrame = 0;
+    m_durable.clear();
+    m_errorString.clear();
+
+    if (m_resumable) {
+        m_durable = ChunkJournal::durableChunks(fileName, rank, m_chunkFrames,
+                                                m_width, m_height);
+        if (!m_durable.isEmpty() && reopenDataset(fileName)) {
+            // Resume frame: end of the contiguous durable prefix. Chunks
+            // beyond it (written out of order before the crash) are skipped
+            // individually in writeBlock()/writeTile().
+            if (rank == 3) {
+                int frame = 0;
+                while (m_durable.contains(quint64(frame))
+                       && frame < m_frameCount) {
+                    frame += m_chunkFrames;
+                }
+                m_resumeFrame = qMin(frame, m_frameCount);
+            }
+            m_journal.beginLog(fileName, rank, m_chunkFrames, m_width, m_height);
+            m_queue.clear();
+            m_ioThread = new HspyIoThread(this);
+            m_ioThread->start();
+            return true;
+        }
+        m_durable.clear();
+    }
+
+    m_file = H5Fcreate(fileName.toLocal8Bit().constData(),
+                       H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if (m_file < 0) {
+        m_errorString = QStringLiteral("Could not create %1").arg(fileName);
+        return false;
+    }
+
+    // HyperSpy expects its data under Experiments/<title>/data; the Python
+    // side fills in the remaining metadata groups after conversion.
+    const hid_t experiments = H5Gcreate2(m_file, "Experiments",
+                                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    const hid_t group = H5Gcreate2(experiments, "__unnamed__",
+                                   H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    const hid_t space = H5Screate_simple(rank, dims, nullptr);
+    const hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, rank, chunk);
+    if (m_compressionLevel > 0) {
+        switch (m_codec) {
+        case Deflate:
+            H5Pset_deflate(dcpl, unsigned(m_compressionLevel));
+            break;
+        case Zstd: {
+            const unsigned cd[1] = { unsigned(m_compressionLevel) };
+            H5Pset_filter(dcpl, kZstdFilter, H5Z_FLAG_OPTIONAL, 1, cd);
+            break;
+        }
+        case LZ4: {
+            const unsigned cd[1] = { 0 }; // default block size
+            H5Pset_filter(dcpl, kLz4Filter, H5Z_FLAG_OPTIONAL, 1, cd);
+            break;
+        }
+        }
+    }
+    // Allocate all chunks up front so direct chunk writes never trigger
+    // metadata growth mid-stream.
+    H5Pset_alloc_time(dcpl, H5D_ALLOC_TIME_EARLY);
+
+    m_dataset = H5Dcreate2(group, "data", H5T_STD_U16LE, space,
+                           H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Pclose(dcpl);
+    H5Sclose(space);
+    H5Gclose(group);
+    H5Gclose(experiments);
+    if (m_dataset < 0) {
+        m_errorString = QStringLiteral("Could not create dataset");
+        closeHandles();
+        return false;
+    }
+
+    if (m_resumable)
+        m_journal.beginLog(fileName, rank, m_chunkFrames, m_width, m_height);
+    m_queue.clear();
+    m_ioThread = new HspyIoThread(this);
+    m_ioThread->start();
+    return true;
+}
+
+//! Opens an interrupted attempt's file for the remaining chunks.
+bool HspyWriter::reopenDataset(const QString &fileName)
+{
+    m_file = H5Fopen(fileName.toLocal8Bit().constData(),
+                     H5F_ACC_RDWR, H5P_DEFAULT);
+    if (m_file < 0)
+        return false;
+    m_dataset = H5Dopen2(m_file, "Experiments/__unnamed__/data", H5P_DEFAULT);
+    if (m_dataset < 0) {
+        closeHandles();
+        return false;
+    }
+    return true;
+}
+
+bool HspyWriter::writeBlock(const DecodedBlock &block)
+{
+    if (m_file < 0 || m_failed)
+        return false;
+    if (m_rank != 3 || block.width != m_width || block.height != m_height
+            || block.firstFrame % m_chunkFrames != 0) {
+        fail(QStringLiteral("Block %1 does not align with the chunk layout")
+             .arg(block.firstFrame));
+        return false;
+    }
+    PendingChunk position;
+    position.rank = 3;
+    position.offset[0] = hsize_t(block.firstFrame);
+    if (m_durable.contains(ChunkJournal::chunkKey(position.offset, 3)))
+        return true; // Already on disk from the interrupted attempt.
+    QByteArray raw(reinterpret_cast<const char *>(block.pixels),
+                   int(block.pixelCount * qint64(sizeof(quint16))));
+    return submitRaw(std::move(position), std::move(raw));
+}
+
+bool HspyWriter::writeTile(int row, int colStart, const quint16 *pixels,
+                           int frameCount)
+{
+    if (m_file < 0 || m_failed)
+        return false;
+    if (m_rank != 4 || colStart % m_chunkFrames != 0
+            || frameCount > m_chunkFrames) {
+        fail(QStringLiteral("Tile (%1, %2) does not align with the chunk layout")
+             .arg(row).arg(colStart));
+        return false;
+    }
+    PendingChunk position;
+    position.rank = 4;
+    position.offset[0] = hsize_t(row);
+    position.offset[1] = hsize_t(colStart);
+    if (m_durable.contains(ChunkJournal::chunkKey(position.offset, 4)))
+        return true;
+    QByteArray raw(reinterpret_cast<const char *>(pixels),
+                   int(qint64(frameCount) * m_height * m_width
+                       * qint64(sizeof(quint16))));
+    return submitRaw(std::move(position), std::move(raw));
+}
+
+bool HspyWriter::submitRaw(PendingChunk &&position, QByteArray &&raw)
+{
+    // A trailing partial block must still fill its whole chunk, or readers
+    // cannot decode it; zero-pad to the chunk size.
+    const qint64 chunkBytes = qint64(m_chunkFrames) * m_height * m_width
+            * qint64(sizeof(quint16));
+    if (raw.size() < chunkBytes)
+        raw.append(QByteArray(int(chunkBytes - raw.size()), '\0'));
+
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_inFlight >= m_inFlightLimit && !m_failed)
+            m_notFull.wait(&m_mutex);
+        if (m_failed)
+            return false;
+        ++m_inFlight;
+    }
+    m_codecPool.start(new ChunkCompressTask(this, std::move(position), std::move(raw)));
+    return true;
+}
+
+void HspyWriter::compressChunk(const PendingChunk &position, const QByteArray &raw)
+{
+    bool ok = true;
+    PendingChunk chunk = position;
+    ScopedStageTimer timer;
+    chunk.payload = m_compressionLevel > 0 ? encode(raw, &ok) : raw;
+    timer.commit(m_profiler, PipelineProfiler::CompressStage,
+                 raw.size(), chunk.payload.size());
+    chunk.filterMask = 0;
+    if (!ok) {
+        fail(QStringLiteral("Chunk compression failed at offset %1")
+             .arg(qint64(position.offset[0])));
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    m_queue.enqueue(std::move(chunk));
+    m_notEmpty.wakeAll();
+}
+
+QByteArray HspyWriter::encode(const QByteArray &raw, bool *ok) const
+{
+    QByteArray out;
+    switch (m_codec) {
+    case Deflate: {
+        uLongf bound = compressBound(uLongf(raw.size()));
+        out.resize(int(bound));
+        *ok = compress2(reinterpret_cast<Bytef *>(out.data()), &bound,
+                        reinterpret_cast<const Bytef *>(raw.constData()),
+                        uLongf(raw.size()), m_compressionLevel) == Z_OK;
+        out.truncate(int(bound));
+        break;
+    }
+    case Zstd: {
+        const size_t bound = ZSTD_compressBound(size_t(raw.size()));
+        out.resize(int(bound));
+        const size_t written = ZSTD_compress(out.data(), bound,
+                                             raw.constData(), size_t(raw.size()),
+                                             m_compressionLevel);
+        *ok = !ZSTD_isError(written);
+        if (*ok)
+            out.truncate(int(written));
+        break;
+    }
+    case LZ4: {
+        // hdf5-lz4 filter framing: big-endian total size (8 bytes) and block
+        // size (4 bytes), then per-block big-endian compressed sizes. One
+        // block per chunk keeps the framing trivial.
+        const int bound = LZ4_compressBound(raw.size());
+        out.resize(12 + 4 + bound);
+        qToBigEndian<quint64>(quint64(raw.size()), reinterpret_cast<uchar *>(out.data()));
+        qToBigEndian<quint32>(quint32(raw.size()), reinterpret_cast<uchar *>(out.data() + 8));
+        const int written = LZ4_compress_default(raw.constData(), out.data() + 16,
+                                                 raw.size(), bound);
+        *ok = written > 0;
+        if (*ok) {
+            qToBigEndian<quint32>(quint32(written),
+                                  reinterpret_cast<uchar *>(out.data() + 12));
+            out.truncate(16 + written);
+        }
+        break;
+    }
+    }
+    return out;
+}
+
+bool HspyWriter::finish()
+{
+    if (m_file < 0)
+        return !m_failed;
+    // Let the codec pool drain first so every chunk reaches the I/O queue,
+    // then tell the I/O thread no more are coming.
+    m_codecPool.waitForDone();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_finishing = true;
+        m_notEmpty.wakeAll();
+    }
+    if (m_ioThread) {
+        m_ioThread->wait();
+        delete m_ioThread;
+        m_ioThread = nullptr;
+    }
+    // Only now is the file quiescent; HDF5 handles are not thread-safe, so
+    // the side datasets go in after the I/O thread has stopped.
+    if (m_stats && !m_failed)
+        writeStatisticsDatasets();
+    // A completed file needs no checkpoint; a failed one keeps the journal
+    // so the next attempt can pick up where this one left off.
+    m_journal.close(!m_failed);
+    closeHandles();
+    return !m_failed;
+}
+
+void HspyWriter::writeStatisticsDatasets()
+{
+    const StreamingStats::Result stats = m_stats->merged();
+    if (stats.width != m_width || stats.height != m_height)
+        return;
+    const hid_t group = H5Gopen2(m_file, "Experiments/__unnamed__", H5P_DEFAULT);
+    if (group < 0)
+        return;
+    const hsize_t imageDims[2] = { hsize_t(stats.height), hsize_t(stats.width) };
+    bool ok = writeSideDataset(group, "sum_image", H5T_STD_U64LE,
+                               H5T_NATIVE_UINT64, 2, imageDims,
+                               stats.sumImage.constData());
+    ok = writeSideDataset(group, "max_pattern", H5T_STD_U16LE,
+                          H5T_NATIVE_UINT16, 2, imageDims,
+                          stats.maxPattern.constData()) && ok;
+    ok = writeSideDataset(group, "mean_pattern", H5T_IEEE_F32LE,
+                          H5T_NATIVE_FLOAT, 2, imageDims,
+                          stats.meanPattern.constData()) && ok;
+    if (!stats.virtualBf.isEmpty()) {
+        const hsize_t bfDims[1] = { hsize_t(stats.virtualBf.size()) };
+        ok = writeSideDataset(group, "virtual_bf", H5T_IEEE_F32LE,
+                              H5T_NATIVE_FLOAT, 1, bfDims,
+                              stats.virtualBf.constData()) && ok;
+    }
+    H5Gclose(group);
+    if (!ok)
+        fail(QStringLiteral("Could not store the summary datasets"));
+}
+
+void HspyWriter::ioLoop()
+{
+    for (;;) {
+        PendingChunk chunk;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queue.isEmpty() && !m_finishing && !m_failed)
+                m_notEmpty.wait(&m_mutex);
+            if (m_queue.isEmpty())
+                return;
+            chunk = m_queue.dequeue();
+        }
+        ScopedStageTimer timer;
+        const herr_t status = H5Dwrite_chunk(m_dataset, H5P_DEFAULT,
+                                             chunk.filterMask, chunk.offset,
+                                             size_t(chunk.payload.size()),
+                                             chunk.payload.constData());
+        timer.commit(m_profiler, PipelineProfiler::WriteStage,
+                     chunk.payload.size(), chunk.payload.size());
+        if (status >= 0 && m_resumable) {
+            m_journal.logChunk(chunk.offset, chunk.rank);
+            if (++m_chunksSinceBarrier >= kChunksPerBarrier) {
+                // Data first, then the barrier record: the journal must
+                // never promise chunks the data file could still lose.
+                H5Fflush(m_file, H5F_SCOPE_GLOBAL);
+                syncToDisk(m_file);
+                m_journal.logBarrier();
+                m_chunksSinceBarrier = 0;
+            }
+        }
+        {
+            QMutexLocker locker(&m_mutex);
+            --m_inFlight;
+            m_notFull.wakeAll();
+        }
+        if (status < 0) {
+            fail(QStringLiteral("H5Dwrite_chunk failed at offset %1")
+                 .arg(qint64(chunk.offset[0])));
+            return;
+        }
+    }
+}
+
+void HspyWriter::fail(const QString &message)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_failed) {
+        m_failed = true;
+        m_errorString = message;
+    }
+    m_notFull.wakeAll();
+    m_notEmpty.wakeAll();
+}
+
+void HspyWriter::closeHandles()
+{
+    if (m_dataset >= 0) {
+        H5Dclose(m_dataset);
+        m_dataset = -1;
+    }
+    if (m_file >= 0) {
+        H5Fclose(m_file);
+        m_file = -1;
+    }
+}
@@ -0,0 +1,162 @@
+#ifndef HSPYWRITER_H
+#define HSPYWRITER_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "chunkjournal.h"
+#include "conversionpipeline.h"
+#include "pipelineprofiler.h"
+
+#include <hdf5.h>
+
+class MemoryBudget;
+class StreamingStats;
+
+//! Streaming chunked HDF5 writer for .hspy output.
+//!
+//! The dataset is allocated up front (early allocation, one chunk per decode
+//! block) and chunks are written with H5Dwrite_chunk, so no reshaped copy of
+//! the stack ever exists in RAM: peak memory is a handful of in-flight
+//! chunks. Chunk compression runs on a pool of workers in parallel with
+//! decoding, while a dedicated I/O thread drains finished chunks to disk;
+//! since every direct chunk write carries its own offset, chunks may reach
+//! the disk in any order.
+class HspyWriter
+{
+public:
+    //! Chunk codec. Deflate is readable everywhere; Zstd and LZ4 need the
+    //! corresponding HDF5 filter plugin on the reading side but compress
+    //! several times faster.
+    enum Codec { Deflate, Zstd, LZ4 };
+
+    HspyWriter();
+    ~HspyWriter();
+
+    HspyWriter(const HspyWriter &) = delete;
+    HspyWriter &operator=(const HspyWriter &) = delete;
+
+    //! Creates \a fileName and allocates a (frameCount, height, width)
+    //! uint16 dataset chunked as (chunkFrames, height, width). The feeding
+    //! pipeline's block size must equal \a chunkFrames.
+    bool create(const QString &fileName, int frameCount,
+                int width, int height, int chunkFrames);
+
+    //! 4D-STEM variant: allocates a (scanRows, scanCols, height, width)
+    //! dataset chunked as (1, chunkCols, height, width), so each chunk is a
+    //! run of frames within one scan row and reshape is pure chunk-offset
+    //! arithmetic.
+    bool create4D(const QString &fileName, int scanRows, int scanCols,
+                  int width, int height, int chunkCols);
+
+    //! Writes one scan-row tile: \a frameCount frames starting at scan
+    //! position (\a row, \a colStart), aligned to the chunkCols grid.
+    //! Same codec-pool path as writeBlock().
+    bool writeTile(int row, int colStart, const quint16 *pixels, int frameCount);
+
+    //! Queues \a block for compression on the worker pool; the chunk goes to
+    //! disk as soon as a codec worker finishes it. Blocks the caller when
+    //! too many chunks are in flight.
+    bool writeBlock(const DecodedBlock &block);
+
+    //! Drains outstanding chunks and closes the file. Returns false if any
+    //! write failed.
+    bool finish();
+
+    int chunkFrames() const { return m_chunkFrames; }
+    QString errorString() const { return m_errorString; }
+
+    //! Codec and level must be set before create(). The level maps onto the
+    //! codec's own scale (deflate 1-9, zstd 1-19; ignored by LZ4), i.e. the
+    //! GUI's speed/ratio slider. Level 0 disables compression.
+    void setCodec(Codec codec) { m_codec = codec; }
+    void setCompressionLevel(int level) { m_compressionLevel = level; }
+    //! Codec worker count; defaults to half the cores so decoding keeps the
+    //! other half.
+    void setCompressionThreads(int threads);
+
+    //! Optional; compress/write timing and byte counts are recorded when
+    //! set.
+    void setProfiler(PipelineProfiler *profiler) { m_profiler = profiler; }
+
+    //! Optional; the in-flight chunk limit is sized from the shared byte
+    //! budget instead of the fixed default. Must be set before create().
+    void setMemoryBudget(const MemoryBudget *budget) { m_budget = budget; }
+
+    //! Optional; the merged sum/max/mean (and virtual bright-field) images
+    //! are stored next to the data when the file is finished.
+    void setStatistics(StreamingStats *stats) { m_stats = stats; }
+
+    //! Enables chunk-level checkpointing: a journal next to the output
+    //! records durably-flushed chunks, create()/create4D() pick up an
+    //! interrupted attempt instead of truncating, and already-durable
+    //! chunks are skipped. Must be set before create().
+    void setResumable(bool resumable) { m_resumable = resumable; }
+    //! First frame the pipeline still has to decode after a resume; 0 for a
+    //! fresh run (and always 0 for 4D output, where only the chunk skip
+    //! applies).
+    int resumeFrame() const { return m_resumeFrame; }
+
+private:
+    friend class HspyIoThread;
+    friend class ChunkCompressTask;
+
+    struct PendingChunk
+    {
+        hsize_t offset[4] = { 0, 0, 0, 0 };
+        int rank = 3;
+        quint32 filterMask = 0;
+        QByteArray payload;
+    };
+
+    //! Runs on the codec pool: compresses one chunk and queues it for I/O.
+    void compressChunk(const PendingChunk &position, const QByteArray &raw);
+    bool submitRaw(PendingChunk &&position, QByteArray &&raw);
+    bool createDataset(const QString &fileName, const hsize_t *dims,
+                       const hsize_t *chunk, int rank);
+    bool reopenDataset(const QString &fileName);
+    QByteArray encode(const QByteArray &raw, bool *ok) const;
+    void writeStatisticsDatasets();
+    void ioLoop();
+    void fail(const QString &message);
+    void closeHandles();
+
+    hid_t m_file = -1;
+    hid_t m_dataset = -1;
+    int m_frameCount = 0;
+    int m_width = 0;
+    int m_height = 0;
+    int m_chunkFrames = 0;
+    int m_rank = 3;
+    Codec m_codec = Deflate;
+    int m_compressionLevel = 1;
+
+    QThreadPool m_codecPool;
+
+    QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QQueue<PendingChunk> m_queue;
+    int m_inFlight = 0;         //!< Chunks being compressed or queued.
+    int m_inFlightLimit = 8;
+    bool m_finishing = false;
+    bool m_failed = false;
+    QString m_errorString;
+    QThread *m_ioThread = nullptr;
+    const MemoryBudget *m_budget = nullptr;
+    PipelineProfiler *m_profiler = nullptr;
+    StreamingStats *m_stats = nullptr;
+
+    bool m_resumable = false;
+    int m_resumeFrame = 0;
+    int m_chunksSinceBarrier = 0; //!< Only touched by the I/O thread.
+    ChunkJournal m_journal;
+    QSet<quint64> m_durable;      //!< Chunks confirmed on disk by a journal.
+};
+
+#endif // HSPYWRITER_H
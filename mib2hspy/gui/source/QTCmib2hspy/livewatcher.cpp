@@ -0,0 +1,82 @@
+#include "livewatcher.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+namespace {
+
+// Poll interval and the number of unchanged polls after which the file is
+// declared stalled. The Merlin streams frames continuously, so a few quiet
+// seconds reliably mean the acquisition has ended.
+const int kPollIntervalMs = 500;
+const int kStallPolls = 10;
+
+} // namespace
+
+LiveWatcher::LiveWatcher(QObject *parent)
+    : QObject(parent)
+{
+    m_pollTimer.setInterval(kPollIntervalMs);
+    connect(&m_pollTimer, &QTimer::timeout, this, &LiveWatcher::poll);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &LiveWatcher::onDirectoryChanged);
+}
+
+void LiveWatcher::watchFolder(const QString &path)
+{
+    stop();
+    m_folder = path;
+    // Existing files belong to finished acquisitions; remember them so only
+    // genuinely new ones trigger a live conversion.
+    const QDir dir(path);
+    const QStringList existing = dir.entryList(
+                QStringList() << QStringLiteral("*.mib"), QDir::Files);
+    for (const QString &name : existing)
+        m_knownFiles.insert(dir.absoluteFilePath(name));
+    m_watcher.addPath(path);
+    m_pollTimer.start();
+}
+
+void LiveWatcher::stop()
+{
+    m_pollTimer.stop();
+    if (!m_watcher.directories().isEmpty())
+        m_watcher.removePaths(m_watcher.directories());
+    m_folder.clear();
+    m_currentFile.clear();
+    m_knownFiles.clear();
+    m_lastSize = -1;
+    m_stalePolls = 0;
+}
+
+void LiveWatcher::onDirectoryChanged(const QString &path)
+{
+    const QDir dir(path);
+    const QStringList entries = dir.entryList(
+                QStringList() << QStringLiteral("*.mib"),
+                QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QString &name : entries) {
+        const QString file = dir.absoluteFilePath(name);
+        if (m_knownFiles.contains(file))
+            continue;
+        m_knownFiles.insert(file);
+        m_currentFile = file;
+        m_lastSize = -1;
+        m_stalePolls = 0;
+        emit mibAppeared(file);
+    }
+}
+
+void LiveWatcher::poll()
+{
+    if (m_currentFile.isEmpty())
+        return;
+    const qint64 size = QFileInfo(m_currentFile).size();
+    if (size != m_lastSize) {
+        m_lastSize = size;
+        m_stalePolls = 0;
+        emit fileGrown(m_currentFile, size);
+    } else if (++m_stalePolls == kStallPolls) {
+        emit fileStalled(m_currentFile);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef LIVEWATCHER_H
+#define LIVEWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+//! Watches an acquisition folder for a .mib being written.
+//!
+//! Purely an observer: it spots new .mib files, polls the current one for
+//! growth twice a second, and reports when the file has stopped growing.
+//! The main window reacts to the signals — opening the reader, feeding the
+//! live pipeline and closing out the conversion — so the watcher stays
+//! usable from tests and other front ends.
+class LiveWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LiveWatcher(QObject *parent = nullptr);
+
+public slots:
+    //! Starts watching \a path. Files already present are ignored; only
+    //! acquisitions that begin afterwards are reported.
+    void watchFolder(const QString &path);
+    void stop();
+
+signals:
+    //! A new .mib appeared; emitted once per file.
+    void mibAppeared(const QString &fileName);
+    //! The current .mib grew to \a size bytes since the last poll.
+    void fileGrown(const QString &fileName, qint64 size);
+    //! The current .mib has not grown for several seconds; the acquisition
+    //! is over (or aborted). Emitted once per file.
+    void fileStalled(const QString &fileName);
+
+private slots:
+    void onDirectoryChanged(const QString &path);
+    void poll();
+
+private:
+    QFileSystemWatcher m_watcher;
+    QTimer m_pollTimer;
+    QString m_folder;
+    QString m_currentFile;
+    QSet<QString> m_knownFiles;
+    qint64 m_lastSize = -1;
+    int m_stalePolls = 0;
+};
+
+#endif // LIVEWATCHER_H
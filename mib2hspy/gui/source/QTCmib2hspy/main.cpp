@@ -1,9 +1,40 @@
+#include "headlessconverter.h"
 #include "mib2hspymainwindow.h"
 
 #include <QApplication>
 
+#include <cstring>
+
+namespace {
+
+//! Headless mode is selected by the converter's own arguments, not by the
+//! mere presence of argc: Qt and X11 options (-style, -platform, -geometry,
+//! …) must still reach QApplication and launch the GUI. --input/--merge
+//! pick the conversion entry points; help goes to the CLI parser too, so
+//! usage prints without a display.
+bool wantsHeadlessMode(int argc, char *argv[])
+{
+    static const char *const headlessArgs[] = {
+        "-i", "--input", "--merge", "-h", "--help"
+    };
+    for (int i = 1; i < argc; ++i) {
+        for (const char *headlessArg : headlessArgs) {
+            if (strcmp(argv[i], headlessArg) == 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 int main(int argc, char *argv[])
 {
+    // Decided before QApplication is constructed so no display connection
+    // is attempted on cluster nodes.
+    if (wantsHeadlessMode(argc, argv))
+        return runHeadlessConversion(argc, argv);
+
     QApplication a(argc, argv);
     mib2hspyMainWindow w;
     w.show();
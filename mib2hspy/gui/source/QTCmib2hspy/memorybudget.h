@@ -0,0 +1,46 @@
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QtGlobal>
+
+//! Global byte budget for in-flight conversion data.
+//!
+//! The pipeline's decoded-block pool and the writer's compressed-chunk
+//! queue both size themselves from one budget instead of fixed counts, so
+//! peak memory is a configurable constant: when the target disk lags, the
+//! writer queue fills, the block pool empties, and the decode workers
+//! block in the pool semaphore until the writer catches up — the
+//! footprint never grows past the budget regardless of input size.
+//!
+//! The split is static (the decoded side takes the lion's share since raw
+//! blocks dwarf compressed chunks); unitsFor() turns a stage's share into
+//! a buffer count for its fixed buffer size.
+class MemoryBudget
+{
+public:
+    MemoryBudget() = default;
+
+    //! Total budget in bytes; 0 restores the 2 GiB default.
+    void setBudget(qint64 bytes) { m_budget = bytes > 0 ? bytes : kDefault; }
+    qint64 budget() const { return m_budget; }
+
+    //! Buffers of \a unitBytes a stage taking \a share of the budget may
+    //! hold, clamped to [\a minimum, \a maximum]. The minimum keeps a
+    //! stage functional even under a budget too small for it; the hard
+    //! floor is then the minimum working set, not zero progress.
+    int unitsFor(qint64 unitBytes, double share, int minimum, int maximum) const
+    {
+        if (unitBytes <= 0)
+            return maximum;
+        const qint64 stageBytes = qint64(m_budget * share);
+        return qBound(qint64(minimum), stageBytes / unitBytes,
+                      qint64(maximum));
+    }
+
+private:
+    static const qint64 kDefault = qint64(2) << 30;
+
+    qint64 m_budget = kDefault;
+};
+
+#endif // MEMORYBUDGET_H
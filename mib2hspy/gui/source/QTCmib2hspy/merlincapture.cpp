@@ -0,0 +1,281 @@
+#include "merlincapture.h"
+
+#include <QList>
+
+#include <cstring>
+
+namespace {
+
+// Capture ring depth. At 256 slots the pool buffers a few seconds of frames
+// ahead of the decode workers before backpressure reaches the socket.
+const int kCaptureSlots = 256;
+// Keep the socket's own buffer bounded so a lagging writer stalls the TCP
+// window instead of growing our heap.
+const qint64 kSocketBufferBytes = 16 * 1024 * 1024;
+const int kRetryIntervalMs = 20;
+
+// Parses one MQ1 frame message (header + payload) the same way the file
+// reader does, with offsets relative to the message start.
+bool parseMq1(const QByteArray &message, quint8 rawCounterDepth,
+              MibFrameHeader *header)
+{
+    const QByteArray probe = QByteArray::fromRawData(
+                message.constData(), int(qMin<qint64>(1024, message.size())));
+    if (!probe.startsWith("MQ1,"))
+        return false;
+    const QList<QByteArray> fields = probe.split(',');
+    if (fields.size() < 7)
+        return false;
+
+    bool ok = false;
+    header->headerOffset = 0;
+    header->frameNumber = fields.at(1).toUInt(&ok);
+    if (!ok)
+        return false;
+    const qint64 headerSize = fields.at(2).toLongLong(&ok);
+    if (!ok || headerSize <= 0 || headerSize > message.size())
+        return false;
+    header->width = fields.at(4).toUShort();
+    header->height = fields.at(5).toUShort();
+    if (header->width == 0 || header->height == 0)
+        return false;
+
+    const QByteArray dataType = fields.at(6).trimmed();
+    const qint64 pixels = qint64(header->width) * header->height;
+    if (dataType == "U08") {
+        header->rawMode = false;
+        header->counterDepth = 8;
+        header->dataSize = pixels;
+    } else if (dataType == "U16") {
+        header->rawMode = false;
+        header->counterDepth = 16;
+        header->dataSize = pixels * 2;
+    } else if (dataType == "U32") {
+        header->rawMode = false;
+        header->counterDepth = 32;
+        header->dataSize = pixels * 4;
+    } else {
+        header->rawMode = true;
+        header->counterDepth = rawCounterDepth;
+        const qint64 bitsPerRow = qint64(header->width) * header->counterDepth;
+        header->dataSize = ((bitsPerRow + 63) / 64) * 8 * header->height;
+    }
+    if (fields.size() > 9)
+        header->timestamp = fields.at(9).trimmed();
+    if (fields.size() > 10)
+        header->exposure = fields.at(10).toDouble();
+
+    header->dataOffset = headerSize;
+    return headerSize + header->dataSize <= message.size();
+}
+
+} // namespace
+
+MerlinCapture::MerlinCapture(QObject *parent)
+    : QObject(parent)
+{
+    m_retryTimer.setInterval(kRetryIntervalMs);
+    m_retryTimer.setSingleShot(true);
+    connect(&m_retryTimer, &QTimer::timeout, this, &MerlinCapture::retryPending);
+    connect(&m_socket, &QTcpSocket::readyRead, this, &MerlinCapture::onReadyRead);
+    connect(&m_socket, &QTcpSocket::disconnected,
+            this, &MerlinCapture::onDisconnected);
+}
+
+MerlinCapture::~MerlinCapture()
+{
+    disconnectFromMerlin();
+}
+
+void MerlinCapture::connectToMerlin(const QString &host, quint16 port)
+{
+    disconnectFromMerlin();
+    m_buffer.clear();
+    m_expectedFrames = 0;
+    m_framesReceived = 0;
+    m_geometryKnown = false;
+    m_finished = false;
+    {
+        QMutexLocker locker(&m_frameMutex);
+        m_frames.clear();
+    }
+    m_socket.setReadBufferSize(kSocketBufferBytes);
+    m_socket.connectToHost(host, port);
+}
+
+void MerlinCapture::disconnectFromMerlin()
+{
+    m_retryTimer.stop();
+    if (m_socket.state() != QAbstractSocket::UnconnectedState) {
+        m_socket.disconnectFromHost();
+        if (m_socket.state() != QAbstractSocket::UnconnectedState)
+            m_socket.abort();
+    }
+}
+
+MibFrameView MerlinCapture::frameView(int index)
+{
+    MibFrameView view;
+    QMutexLocker locker(&m_frameMutex);
+    const CapturedFrame frame = m_frames.value(index);
+    if (frame.slot < 0)
+        return view;
+    view.header = frame.header;
+    view.data = reinterpret_cast<const uchar *>(m_pool.slotData(frame.slot));
+    view.size = frame.header.dataSize;
+    return view;
+}
+
+void MerlinCapture::releaseFrame(int index)
+{
+    int slot = -1;
+    {
+        QMutexLocker locker(&m_frameMutex);
+        const CapturedFrame frame = m_frames.take(index);
+        slot = frame.slot;
+    }
+    if (slot >= 0)
+        m_pool.release(slot);
+}
+
+void MerlinCapture::onReadyRead()
+{
+    // While a frame is parked waiting for a pool slot the socket is not
+    // read, so the kernel buffer and then the TCP window fill up and the
+    // detector-side interface throttles.
+    if (m_retryTimer.isActive())
+        return;
+    m_buffer.append(m_socket.readAll());
+    processBuffer();
+}
+
+void MerlinCapture::retryPending()
+{
+    processBuffer();
+    if (!m_retryTimer.isActive() && m_socket.bytesAvailable() > 0)
+        onReadyRead();
+}
+
+void MerlinCapture::onDisconnected()
+{
+    processBuffer();
+    if (!m_finished) {
+        m_finished = true;
+        emit captureFinished();
+    }
+}
+
+void MerlinCapture::processBuffer()
+{
+    // Stream framing: "MPX,<length>," where the ASCII length counts the
+    // trailing comma plus the payload, so payload = length - 1 bytes.
+    qint64 consumed = 0;
+    while (true) {
+        const qint64 remaining = m_buffer.size() - consumed;
+        if (remaining < 15)
+            break;
+        const char *base = m_buffer.constData() + consumed;
+        if (memcmp(base, "MPX,", 4) != 0) {
+            // Resync on a garbled stream rather than aborting the capture.
+            const int next = m_buffer.indexOf("MPX,", int(consumed + 1));
+            if (next < 0) {
+                consumed = m_buffer.size();
+                break;
+            }
+            consumed = next;
+            continue;
+        }
+        const int lengthEnd = m_buffer.indexOf(',', int(consumed + 4));
+        if (lengthEnd < 0)
+            break;
+        bool ok = false;
+        const qint64 length = m_buffer.mid(int(consumed + 4),
+                                           lengthEnd - int(consumed) - 4)
+                .toLongLong(&ok);
+        if (!ok || length <= 0) {
+            consumed += 4;
+            continue;
+        }
+        const qint64 payloadSize = length - 1;
+        const qint64 messageEnd = qint64(lengthEnd) + 1 + payloadSize;
+        if (messageEnd > m_buffer.size())
+            break;
+        if (!handleMessage(m_buffer.constData() + lengthEnd + 1, payloadSize)) {
+            // Pool exhausted: leave the message in the buffer and retry once
+            // the writer has caught up.
+            m_retryTimer.start();
+            break;
+        }
+        consumed = messageEnd;
+    }
+    if (consumed > 0)
+        m_buffer.remove(0, int(consumed));
+}
+
+bool MerlinCapture::handleMessage(const char *data, qint64 size)
+{
+    if (size >= 4 && memcmp(data, "HDR,", 4) == 0) {
+        parseAcquisitionHeader(QByteArray(data, int(size)));
+        return true;
+    }
+    if (size >= 4 && memcmp(data, "MQ1,", 4) == 0)
+        return storeFrame(data, size);
+    return true; // Unknown message kind; skip it.
+}
+
+//! The acquisition header is the same key/value text as the companion .hdr
+//! file; only the two fields that shape the conversion are needed here.
+void MerlinCapture::parseAcquisitionHeader(const QByteArray &header)
+{
+    for (const QByteArray &line : header.split('\n')) {
+        const int colon = line.indexOf(':');
+        if (colon < 0)
+            continue;
+        const QByteArray key = line.left(colon).trimmed();
+        const QByteArray value = line.mid(colon + 1).trimmed();
+        if (key.startsWith("Frames in Acquisition"))
+            m_expectedFrames = value.toInt();
+        else if (key.startsWith("Counter Depth")) {
+            const int depth = value.toInt();
+            if (depth > 0)
+                m_rawCounterDepth = quint8(depth);
+        }
+    }
+}
+
+bool MerlinCapture::storeFrame(const char *data, qint64 size)
+{
+    const QByteArray message = QByteArray::fromRawData(data, int(size));
+    MibFrameHeader header;
+    if (!parseMq1(message, m_rawCounterDepth, &header))
+        return true; // Malformed frame; drop it rather than stall the stream.
+
+    if (!m_geometryKnown) {
+        m_pool.configure(header.dataSize, kCaptureSlots);
+        m_geometryKnown = true;
+        emit acquisitionStarted(m_expectedFrames, header.width, header.height);
+    }
+
+    int slot = -1;
+    if (!m_pool.tryAcquire(&slot))
+        return false;
+    memcpy(m_pool.slotData(slot), data + header.dataOffset,
+           size_t(header.dataSize));
+
+    CapturedFrame frame;
+    frame.slot = slot;
+    frame.header = header;
+    frame.header.dataOffset = 0; // Payload sits at the start of the slot.
+    {
+        QMutexLocker locker(&m_frameMutex);
+        m_frames.insert(m_framesReceived, frame);
+    }
+    ++m_framesReceived;
+    emit framesAvailable(m_framesReceived);
+    if (m_expectedFrames > 0 && m_framesReceived >= m_expectedFrames
+            && !m_finished) {
+        m_finished = true;
+        emit captureFinished();
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef MERLINCAPTURE_H
+#define MERLINCAPTURE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "framebufferpool.h"
+#include "mibreader.h"
+
+//! Capture front-end reading frames straight off the Merlin data socket.
+//!
+//! The data port streams the acquisition header followed by one MQ1 frame
+//! per "MPX,<length>," message. Completed frames land in the same kind of
+//! pooled buffers the file path uses and are handed to the pipeline as
+//! zero-copy MibFrameViews through its frame-source hooks, so the decode,
+//! correction, statistics and write stages are byte-for-byte identical to a
+//! file conversion — just without the .mib round-trip over the disk. When
+//! the pool fills because the writer lags, the socket is simply not read,
+//! which pushes the backpressure onto TCP.
+class MerlinCapture : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MerlinCapture(QObject *parent = nullptr);
+    ~MerlinCapture();
+
+    //! Counter depth for raw (R64) frames; the acquisition header normally
+    //! supplies it, this is the fallback.
+    void setRawCounterDepth(quint8 bits) { m_rawCounterDepth = bits; }
+
+    //! Pipeline frame source: view of captured frame \a index. Valid until
+    //! releaseFrame(\a index).
+    MibFrameView frameView(int index);
+    //! Pipeline frame release: returns the frame's pool slot.
+    void releaseFrame(int index);
+
+    int frameCount() const { return m_framesReceived; }
+
+public slots:
+    //! Connects to the Merlin data port and starts capturing.
+    void connectToMerlin(const QString &host, quint16 port = 6342);
+    void disconnectFromMerlin();
+
+signals:
+    //! The acquisition header arrived and the first frame fixed the
+    //! geometry; the conversion can be set up now.
+    void acquisitionStarted(int expectedFrames, int width, int height);
+    //! Frames [0, \a frames) have been captured.
+    void framesAvailable(int frames);
+    //! The expected frame count arrived or the detector closed the socket.
+    void captureFinished();
+    void errorOccurred(const QString &message);
+
+private slots:
+    void onReadyRead();
+    void onDisconnected();
+    void retryPending();
+
+private:
+    void processBuffer();
+    bool handleMessage(const char *data, qint64 size);
+    void parseAcquisitionHeader(const QByteArray &header);
+    bool storeFrame(const char *data, qint64 size);
+
+    QTcpSocket m_socket;
+    QTimer m_retryTimer;        //!< Re-runs the parser once slots free up.
+    QByteArray m_buffer;
+    FrameBufferPool m_pool;
+    quint8 m_rawCounterDepth = 12;
+    int m_expectedFrames = 0;
+    int m_framesReceived = 0;
+    bool m_geometryKnown = false;
+    bool m_finished = false;
+
+    //! One captured frame: its pool slot and the parsed MQ1 header.
+    struct CapturedFrame
+    {
+        int slot = -1;
+        MibFrameHeader header;
+    };
+    mutable QMutex m_frameMutex;
+    QHash<int, CapturedFrame> m_frames;
+};
+
+#endif // MERLINCAPTURE_H
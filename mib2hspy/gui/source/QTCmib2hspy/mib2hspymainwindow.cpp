@@ -1,11 +1,412 @@
 #include "mib2hspymainwindow.h"
+#include "hdrparser.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QDockWidget>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QMessageBox>
+#include <QStatusBar>
+
+namespace {
+
+//! The input's sibling with \a suffix as the extension; derived via
+//! QFileInfo so a ".mib" occurring in a directory name is left alone.
+QString siblingFile(const QString &fileName, const QString &suffix)
+{
+    const QFileInfo info(fileName);
+    return info.path() + QLatin1Char('/') + info.completeBaseName() + suffix;
+}
+
+} // namespace
 
 mib2hspyMainWindow::mib2hspyMainWindow(QWidget *parent)
     : QMainWindow(parent)
+    , m_pipeline(new ConversionPipeline(this))
+    , m_frameBrowser(new FrameBrowser(this))
+{
+    setCentralWidget(m_frameBrowser);
+    m_pipeline->setReader(&m_reader);
+    m_pipeline->setProfiler(&m_profiler);
+    m_writer.setProfiler(&m_profiler);
+    m_pipeline->setStatistics(&m_stats);
+    m_writer.setStatistics(&m_stats);
+    m_writer.setResumable(true);
+    m_pipeline->setMemoryBudget(&m_budget);
+    m_writer.setMemoryBudget(&m_budget);
+
+    m_profilerPanel = new ProfilerPanel(&m_profiler, this);
+    QDockWidget *profilerDock = new QDockWidget(tr("Pipeline"), this);
+    profilerDock->setWidget(m_profilerPanel);
+    addDockWidget(Qt::RightDockWidgetArea, profilerDock);
+
+    m_liveWatcher = new LiveWatcher(this);
+    connect(m_liveWatcher, &LiveWatcher::mibAppeared,
+            this, &mib2hspyMainWindow::onLiveMibAppeared);
+    connect(m_liveWatcher, &LiveWatcher::fileGrown,
+            this, &mib2hspyMainWindow::onLiveFileGrown);
+    connect(m_liveWatcher, &LiveWatcher::fileStalled,
+            this, &mib2hspyMainWindow::onLiveFileStalled);
+
+    m_capture = new MerlinCapture(this);
+    connect(m_capture, &MerlinCapture::acquisitionStarted,
+            this, &mib2hspyMainWindow::onCaptureStarted);
+    connect(m_capture, &MerlinCapture::framesAvailable,
+            this, &mib2hspyMainWindow::onCaptureFrames);
+    connect(m_capture, &MerlinCapture::captureFinished,
+            this, &mib2hspyMainWindow::onCaptureFinished);
+    // Signals arrive from the worker/writer threads; the queued connections
+    // keep all GUI updates on this thread.
+    connect(m_pipeline, &ConversionPipeline::progressChanged,
+            this, &mib2hspyMainWindow::onConversionProgress, Qt::QueuedConnection);
+    connect(m_pipeline, &ConversionPipeline::finished,
+            this, &mib2hspyMainWindow::onConversionFinished, Qt::QueuedConnection);
+
+    loadSettings();
+}
+
+//! One binary read at startup; the first launch (or a format bump)
+//! migrates the legacy settings.txt next to the executable.
+void mib2hspyMainWindow::loadSettings()
 {
+    const QString legacy = QDir(QCoreApplication::applicationDirPath())
+            .filePath(QStringLiteral("settings.txt"));
+    if (!m_settings.loadOrMigrate(SettingsStore::storeFileName(legacy), legacy))
+        return;
+    m_compressionCodec = m_settings.value(QStringLiteral("compression_codec"),
+                                          QString::number(m_compressionCodec))
+            .toInt();
+    m_compressionLevel = m_settings.value(QStringLiteral("compression_level"),
+                                          QString::number(m_compressionLevel))
+            .toInt();
+    const QString mask = m_settings.value(QStringLiteral("pixel_mask_file"));
+    if (!mask.isEmpty() && m_corrector.loadMask(mask))
+        m_pixelCorrectionEnabled = true;
+    const int budgetMb = m_settings.value(QStringLiteral("memory_budget_mb"),
+                                          QStringLiteral("0")).toInt();
+    m_budget.setBudget(qint64(budgetMb) << 20);
+    const QString calibrations = m_settings.value(QStringLiteral("calibration_file"));
+    if (!calibrations.isEmpty())
+        m_calibrations.load(calibrations);
 }
 
 mib2hspyMainWindow::~mib2hspyMainWindow()
 {
 }
 
+void mib2hspyMainWindow::openMib(const QString &fileName)
+{
+    // The companion .hdr carries the counter depth that raw-mode MQ1
+    // headers lack.
+    const MedipixHdr hdr(siblingFile(fileName, QStringLiteral(".hdr")));
+    if (hdr.isValid() && hdr.counterDepth > 0)
+        m_reader.setRawCounterDepth(quint8(hdr.counterDepth));
+
+    if (!m_reader.open(fileName)) {
+        QMessageBox::warning(this, tr("mib2hspy"),
+                             tr("Could not open \"%1\": %2")
+                             .arg(fileName, m_reader.errorString()));
+        return;
+    }
+    m_frameBrowser->setReader(&m_reader);
+    statusBar()->showMessage(tr("Opened %1 (%2 frames)")
+                             .arg(fileName).arg(m_reader.frameCount()));
+}
+
+void mib2hspyMainWindow::startConversion()
+{
+    if (!m_reader.isOpen())
+        return;
+    const QString outName = siblingFile(m_reader.fileName(),
+                                        QStringLiteral(".hspy"));
+    startPipeline(outName, m_reader.frameCount(), m_reader.frameHeader(0), false);
+}
+
+bool mib2hspyMainWindow::startPipeline(const QString &outName, int frameCount,
+                                       const MibFrameHeader &first, bool live)
+{
+    // File-based runs pull from the reader; the capture path installs its
+    // socket-backed source before calling here.
+    if (!m_captureActive) {
+        m_pipeline->setFrameSource(ConversionPipeline::FrameSource(),
+                                   ConversionPipeline::FrameRelease());
+    }
+    m_writer.setCodec(HspyWriter::Codec(m_compressionCodec));
+    m_writer.setCompressionLevel(m_compressionLevel);
+    if (!m_writer.create(outName, frameCount, first.width, first.height, 64)) {
+        QMessageBox::warning(this, tr("mib2hspy"), m_writer.errorString());
+        return false;
+    }
+    m_pipeline->setBlockSize(m_writer.chunkFrames());
+    m_pipeline->setStartFrame(m_writer.resumeFrame());
+    m_pipeline->setLiveMode(live);
+    m_pipeline->setExpectedFrames(live ? frameCount : 0);
+    // A resumed run never sees the already-durable frames, so the one-pass
+    // reductions would come out partial; skip them rather than store wrong
+    // summaries.
+    const bool resumed = m_writer.resumeFrame() > 0;
+    m_pipeline->setStatistics(resumed ? nullptr : &m_stats);
+    m_writer.setStatistics(resumed ? nullptr : &m_stats);
+    if (resumed) {
+        statusBar()->showMessage(tr("Resuming at frame %1")
+                                 .arg(m_writer.resumeFrame()));
+    }
+    m_stats.begin(first.width, first.height, frameCount);
+    // Default virtual bright-field detector: a centered disk covering the
+    // unscattered beam on a roughly centered diffraction pattern.
+    if (m_bfRadius > 0)
+        m_stats.setVirtualDisk(m_bfCenterX, m_bfCenterY, m_bfRadius);
+    else
+        m_stats.setVirtualDisk(first.width / 2, first.height / 2,
+                               first.width / 8);
+    if (m_pixelCorrectionEnabled) {
+        m_corrector.prepare(first.width, first.height);
+        m_pipeline->setPixelCorrector(m_corrector.isReady() ? &m_corrector
+                                                            : nullptr);
+    } else {
+        m_pipeline->setPixelCorrector(nullptr);
+    }
+    m_pipeline->setBlockSink([this](const DecodedBlock &block) {
+        return m_writer.writeBlock(block);
+    });
+    m_outputFile = outName;
+    m_profiler.reset();
+    m_profilerPanel->startPolling();
+    m_pipeline->start();
+    if (live && !m_captureActive)
+        m_pipeline->extendTo(m_reader.frameCount());
+    return true;
+}
+
+void mib2hspyMainWindow::startCapture(const QString &host,
+                                      const QString &outputFile)
+{
+    if (m_pipeline->isRunning())
+        return;
+    m_captureActive = true;
+    m_captureOutputFile = outputFile;
+    // A capture cannot resume — the frames exist only in flight — so any
+    // leftover checkpoint for this output must not shift the start frame.
+    QFile::remove(ChunkJournal::journalFileName(outputFile));
+    m_capture->connectToMerlin(host);
+    statusBar()->showMessage(tr("Capturing from %1").arg(host));
+}
+
+void mib2hspyMainWindow::stopCapture()
+{
+    m_capture->disconnectFromMerlin();
+    if (m_pipeline->isRunning())
+        m_pipeline->finishInput();
+    m_captureActive = false;
+}
+
+void mib2hspyMainWindow::onCaptureStarted(int expectedFrames, int width,
+                                          int height)
+{
+    if (!m_captureActive)
+        return;
+    if (expectedFrames <= 0) {
+        QMessageBox::warning(this, tr("mib2hspy"),
+                             tr("The Merlin did not announce an acquisition "
+                                "length; cannot size the output"));
+        stopCapture();
+        return;
+    }
+    m_pipeline->setFrameSource(
+                [this](int index) { return m_capture->frameView(index); },
+                [this](int index) { m_capture->releaseFrame(index); });
+    m_pipeline->setFrameGeometry(quint16(width), quint16(height));
+    MibFrameHeader proto;
+    proto.width = quint16(width);
+    proto.height = quint16(height);
+    if (!startPipeline(m_captureOutputFile, expectedFrames, proto, true))
+        stopCapture();
+}
+
+void mib2hspyMainWindow::onCaptureFrames(int frames)
+{
+    if (m_captureActive)
+        m_pipeline->extendTo(frames);
+}
+
+void mib2hspyMainWindow::onCaptureFinished()
+{
+    if (m_captureActive)
+        m_pipeline->finishInput();
+}
+
+void mib2hspyMainWindow::startLiveMode(const QString &folder)
+{
+    if (m_pipeline->isRunning())
+        return;
+    m_liveActive = true;
+    m_liveStarted = false;
+    m_liveWatcher->watchFolder(folder);
+    statusBar()->showMessage(tr("Live mode: watching %1").arg(folder));
+}
+
+void mib2hspyMainWindow::stopLiveMode()
+{
+    m_liveWatcher->stop();
+    if (m_liveStarted)
+        m_pipeline->finishInput();
+    m_liveActive = false;
+    m_liveStarted = false;
+    m_pipeline->setLiveMode(false);
+}
+
+void mib2hspyMainWindow::onLiveMibAppeared(const QString &fileName)
+{
+    statusBar()->showMessage(tr("Acquisition started: %1").arg(fileName));
+}
+
+void mib2hspyMainWindow::onLiveFileGrown(const QString &fileName, qint64 size)
+{
+    Q_UNUSED(size)
+    if (!m_liveActive)
+        return;
+    if (!m_liveStarted) {
+        tryStartLiveConversion(fileName);
+        return;
+    }
+    if (m_reader.refresh() > 0)
+        m_pipeline->extendTo(m_reader.frameCount());
+    if (m_liveExpectedFrames > 0
+            && m_reader.frameCount() >= m_liveExpectedFrames) {
+        m_pipeline->finishInput();
+    }
+}
+
+void mib2hspyMainWindow::onLiveFileStalled(const QString &fileName)
+{
+    Q_UNUSED(fileName)
+    if (!m_liveActive || !m_liveStarted)
+        return;
+    if (m_reader.refresh() > 0)
+        m_pipeline->extendTo(m_reader.frameCount());
+    m_pipeline->finishInput();
+}
+
+//! Called on every growth poll until the .hdr and the first complete frame
+//! are both on disk, then brings up the normal pipeline in live mode.
+void mib2hspyMainWindow::tryStartLiveConversion(const QString &fileName)
+{
+    const MedipixHdr hdr(siblingFile(fileName, QStringLiteral(".hdr")));
+    // The .hdr is written at acquisition start and carries the counter depth
+    // and the acquisition length, which sizes the early-allocated dataset.
+    if (!hdr.isValid() || hdr.framesInAcquisition <= 0)
+        return;
+    if (hdr.counterDepth > 0)
+        m_reader.setRawCounterDepth(quint8(hdr.counterDepth));
+    if (!m_reader.open(fileName))
+        return;
+    m_liveExpectedFrames = hdr.framesInAcquisition;
+    m_reader.reserveFrames(m_liveExpectedFrames);
+    m_frameBrowser->setReader(&m_reader);
+
+    const QString outName = siblingFile(fileName, QStringLiteral(".hspy"));
+    if (!startPipeline(outName, m_liveExpectedFrames,
+                       m_reader.frameHeader(0), true)) {
+        stopLiveMode();
+        return;
+    }
+    m_liveStarted = true;
+}
+
+void mib2hspyMainWindow::cancelConversion()
+{
+    m_pipeline->cancel();
+}
+
+void mib2hspyMainWindow::setCompressionCodec(int codec)
+{
+    m_compressionCodec = codec;
+    m_settings.setValue(QStringLiteral("compression_codec"),
+                        QString::number(codec));
+    m_settings.save();
+}
+
+void mib2hspyMainWindow::setCompressionLevel(int level)
+{
+    m_compressionLevel = level;
+    m_settings.setValue(QStringLiteral("compression_level"),
+                        QString::number(level));
+    m_settings.save();
+}
+
+void mib2hspyMainWindow::setMemoryBudgetMb(int megabytes)
+{
+    m_budget.setBudget(qint64(megabytes) << 20);
+    m_settings.setValue(QStringLiteral("memory_budget_mb"),
+                        QString::number(megabytes));
+    m_settings.save();
+}
+
+void mib2hspyMainWindow::setVirtualDetector(int centerX, int centerY, int radius)
+{
+    m_bfCenterX = centerX;
+    m_bfCenterY = centerY;
+    m_bfRadius = radius;
+}
+
+void mib2hspyMainWindow::setCalibrationFile(const QString &fileName)
+{
+    if (!m_calibrations.load(fileName)) {
+        QMessageBox::warning(this, tr("mib2hspy"), m_calibrations.errorString());
+        return;
+    }
+    statusBar()->showMessage(tr("Indexed %1 calibration rows")
+                             .arg(m_calibrations.rowCount()));
+    m_settings.setValue(QStringLiteral("calibration_file"), fileName);
+    m_settings.save();
+}
+
+void mib2hspyMainWindow::setPixelMaskFile(const QString &fileName)
+{
+    if (!m_corrector.loadMask(fileName)) {
+        QMessageBox::warning(this, tr("mib2hspy"), m_corrector.errorString());
+        m_pixelCorrectionEnabled = false;
+        return;
+    }
+    statusBar()->showMessage(tr("Loaded %1 pixel defects")
+                             .arg(m_corrector.badPixelCount()));
+    m_settings.setValue(QStringLiteral("pixel_mask_file"), fileName);
+    m_settings.save();
+}
+
+void mib2hspyMainWindow::setPixelCorrectionEnabled(bool enabled)
+{
+    m_pixelCorrectionEnabled = enabled;
+}
+
+void mib2hspyMainWindow::onConversionProgress(int framesDone, int framesTotal)
+{
+    statusBar()->showMessage(tr("Converting: %1 / %2 frames")
+                             .arg(framesDone).arg(framesTotal));
+}
+
+void mib2hspyMainWindow::onConversionFinished(bool success)
+{
+    success = m_writer.finish() && success;
+    m_profilerPanel->stopPolling();
+    // Per-stage totals next to the output, for offline diagnosis of slow
+    // conversions.
+    if (!m_outputFile.isEmpty()) {
+        QFile profileFile(m_outputFile + QStringLiteral(".profile.json"));
+        if (profileFile.open(QIODevice::WriteOnly))
+            profileFile.write(QJsonDocument(m_profiler.toJson()).toJson());
+    }
+    statusBar()->showMessage(success ? tr("Conversion finished")
+                                     : tr("Conversion stopped"));
+    // In live mode, stay armed for the next acquisition in the folder.
+    if (m_liveActive) {
+        m_liveStarted = false;
+        m_pipeline->setLiveMode(false);
+    }
+    if (m_captureActive) {
+        m_captureActive = false;
+        m_pipeline->setLiveMode(false);
+    }
+}
@@ -3,6 +3,20 @@
 
 #include <QMainWindow>
 
+#include "mibreader.h"
+#include "calibrationindex.h"
+#include "conversionpipeline.h"
+#include "framebrowser.h"
+#include "hspywriter.h"
+#include "livewatcher.h"
+#include "memorybudget.h"
+#include "merlincapture.h"
+#include "pipelineprofiler.h"
+#include "pixelcorrector.h"
+#include "profilerpanel.h"
+#include "settingsstore.h"
+#include "streamingstats.h"
+
 class mib2hspyMainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -10,5 +24,99 @@ class mib2hspyMainWindow : public QMainWindow
 public:
     mib2hspyMainWindow(QWidget *parent = nullptr);
     ~mib2hspyMainWindow();
+
+    //! Single-probe calibration lookup for the parameters window; returns
+    //! an invalid entry when no table is loaded or the condition has no
+    //! calibration.
+    CalibrationEntry calibration(const CalibrationKey &key) const
+    {
+        return m_calibrations.lookup(key);
+    }
+
+public slots:
+    //! Opens \a fileName with the memory-mapped reader and readies the
+    //! pipeline for conversion.
+    void openMib(const QString &fileName);
+    void startConversion();
+    void cancelConversion();
+
+    //! Live mode: watches \a folder for a new acquisition and converts the
+    //! growing .mib as frames land, so the .hspy is complete moments after
+    //! the scan ends.
+    void startLiveMode(const QString &folder);
+    void stopLiveMode();
+
+    //! Capture mode: converts frames straight off the Merlin data socket,
+    //! skipping the raw .mib on disk entirely. Output goes to
+    //! \a outputFile.
+    void startCapture(const QString &host, const QString &outputFile);
+    void stopCapture();
+
+    //! Bound to the codec/level controls in the settings dialog; applied to
+    //! the writer when the next conversion starts.
+    void setCompressionCodec(int codec);
+    void setCompressionLevel(int level);
+
+    //! Bound to the memory-budget spinbox in the settings dialog; caps the
+    //! conversion's in-flight data from the next run on.
+    void setMemoryBudgetMb(int megabytes);
+
+    //! Virtual bright-field detector for the streaming statistics; a
+    //! negative radius keeps the default centered disk.
+    void setVirtualDetector(int centerX, int centerY, int radius);
+
+    //! Bound to the calibration-file field in the settings dialog; (re)builds
+    //! the lookup index from the CSV export of the calibration table.
+    void setCalibrationFile(const QString &fileName);
+
+    //! Bound to the defect-correction controls in the settings dialog. The
+    //! mask file lists one "x y" defect per line.
+    void setPixelMaskFile(const QString &fileName);
+    void setPixelCorrectionEnabled(bool enabled);
+
+private slots:
+    void onConversionProgress(int framesDone, int framesTotal);
+    void onConversionFinished(bool success);
+    void onLiveMibAppeared(const QString &fileName);
+    void onLiveFileGrown(const QString &fileName, qint64 size);
+    void onLiveFileStalled(const QString &fileName);
+    void onCaptureStarted(int expectedFrames, int width, int height);
+    void onCaptureFrames(int frames);
+    void onCaptureFinished();
+
+private:
+    //! Shared writer/pipeline setup for batch and live conversions.
+    bool startPipeline(const QString &outName, int frameCount,
+                       const MibFrameHeader &first, bool live);
+    void tryStartLiveConversion(const QString &fileName);
+    //! Pulls the persisted converter options out of the binary store.
+    void loadSettings();
+
+    SettingsStore m_settings;
+    MemoryBudget m_budget;
+    CalibrationIndex m_calibrations;
+
+    MibReader m_reader;
+    ConversionPipeline *m_pipeline;
+    HspyWriter m_writer;
+    FrameBrowser *m_frameBrowser;
+    PipelineProfiler m_profiler;
+    ProfilerPanel *m_profilerPanel;
+    StreamingStats m_stats;
+    PixelCorrector m_corrector;
+    bool m_pixelCorrectionEnabled = false;
+    LiveWatcher *m_liveWatcher;
+    bool m_liveActive = false;
+    bool m_liveStarted = false;
+    int m_liveExpectedFrames = 0;
+    MerlinCapture *m_capture;
+    bool m_captureActive = false;
+    QString m_captureOutputFile;
+    QString m_outputFile;
+    int m_bfCenterX = -1;
+    int m_bfCenterY = -1;
+    int m_bfRadius = -1;
+    int m_compressionCodec = HspyWriter::Deflate;
+    int m_compressionLevel = 1;
 };
 #endif // MIB2HSPYMAINWINDOW_H
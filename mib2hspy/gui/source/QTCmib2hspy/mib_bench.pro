@@ -0,0 +1,43 @@
+QT       += core
+
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+# Throughput benchmark for the native conversion engine. Shares the engine
+# sources with QTCmib2hspy so the numbers track exactly what the GUI ships.
+# Build with: qmake mib_bench.pro && make
+
+linux-g++|macx-clang: QMAKE_CXXFLAGS += -mavx2
+win32-msvc: QMAKE_CXXFLAGS += /arch:AVX2
+
+LIBS += -lhdf5 -lz -lzstd -llz4
+
+SOURCES += \
+    bench_main.cpp \
+    bitunpack.cpp \
+    chunkjournal.cpp \
+    conversionpipeline.cpp \
+    decodekernels.cpp \
+    framebufferpool.cpp \
+    hspywriter.cpp \
+    mibindex.cpp \
+    pixelcorrector.cpp \
+    pipelineprofiler.cpp \
+    streamingstats.cpp \
+    mibreader.cpp
+
+HEADERS += \
+    bitunpack.h \
+    chunkjournal.h \
+    conversionpipeline.h \
+    decodekernels.h \
+    framebufferpool.h \
+    hspywriter.h \
+    memorybudget.h \
+    mibindex.h \
+    pixelcorrector.h \
+    pipelineprofiler.h \
+    streamingstats.h \
+    mibreader.h
@@ -0,0 +1,81 @@
+#include "mibfileset.h"
+
+#include <algorithm>
+
+MibFileSet::~MibFileSet()
+{
+    close();
+}
+
+bool MibFileSet::open(const QStringList &fileNames)
+{
+    close();
+    if (fileNames.isEmpty()) {
+        m_errorString = QStringLiteral("No input files");
+        return false;
+    }
+    for (const QString &fileName : fileNames) {
+        MibReader *reader = new MibReader;
+        reader->setRawCounterDepth(m_rawCounterDepth);
+        if (!reader->open(fileName)) {
+            m_errorString = QStringLiteral("%1: %2")
+                    .arg(fileName, reader->errorString());
+            delete reader;
+            close();
+            return false;
+        }
+        if (!m_readers.isEmpty()) {
+            const MibFrameHeader &first = m_readers.first()->frameHeader(0);
+            const MibFrameHeader &ours = reader->frameHeader(0);
+            if (ours.width != first.width || ours.height != first.height
+                    || ours.counterDepth != first.counterDepth) {
+                m_errorString = QStringLiteral(
+                            "%1 does not match the geometry of %2")
+                        .arg(fileName, m_readers.first()->fileName());
+                delete reader;
+                close();
+                return false;
+            }
+        }
+        m_firstFrame.append(m_totalFrames);
+        m_totalFrames += reader->frameCount();
+        m_readers.append(reader);
+    }
+    return true;
+}
+
+void MibFileSet::close()
+{
+    qDeleteAll(m_readers);
+    m_readers.clear();
+    m_firstFrame.clear();
+    m_totalFrames = 0;
+    m_errorString.clear();
+}
+
+int MibFileSet::locate(int globalIndex, int *localIndex) const
+{
+    // Last file whose first frame is <= globalIndex.
+    const int file = int(std::upper_bound(m_firstFrame.constBegin(),
+                                          m_firstFrame.constEnd(), globalIndex)
+                         - m_firstFrame.constBegin()) - 1;
+    *localIndex = globalIndex - m_firstFrame.at(file);
+    return file;
+}
+
+const MibFrameHeader &MibFileSet::frameHeader(int globalIndex) const
+{
+    int local = 0;
+    const int file = locate(globalIndex, &local);
+    return m_readers.at(file)->frameHeader(local);
+}
+
+MibFrameView MibFileSet::frame(int globalIndex) const
+{
+    MibFrameView view;
+    if (globalIndex < 0 || globalIndex >= m_totalFrames)
+        return view;
+    int local = 0;
+    const int file = locate(globalIndex, &local);
+    return m_readers.at(file)->frame(local);
+}
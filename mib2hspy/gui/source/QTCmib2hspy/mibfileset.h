@@ -0,0 +1,54 @@
+#ifndef MIBFILESET_H
+#define MIBFILESET_H
+
+#include <QStringList>
+#include <QVector>
+
+#include "mibreader.h"
+
+//! A chained acquisition split across several .mib files, presented as one
+//! contiguous frame range.
+//!
+//! Each file gets its own memory-mapped reader (so the sidecar indices are
+//! reused per file) and global frame indices are translated with a binary
+//! search over the per-file start offsets. Frame views remain zero-copy; the
+//! set plugs into the pipeline through its frame-source hooks, so a 4-file
+//! acquisition converts in one parallel pass into a single dataset.
+class MibFileSet
+{
+public:
+    MibFileSet() = default;
+    ~MibFileSet();
+
+    MibFileSet(const MibFileSet &) = delete;
+    MibFileSet &operator=(const MibFileSet &) = delete;
+
+    //! Opens the files in the given order; global frame numbering follows
+    //! it. All files must share the frame geometry of the first.
+    bool open(const QStringList &fileNames);
+    void close();
+    bool isOpen() const { return !m_readers.isEmpty(); }
+
+    int fileCount() const { return m_readers.size(); }
+    int frameCount() const { return m_totalFrames; }
+    QString errorString() const { return m_errorString; }
+
+    //! Applies to all subsequently opened files; see
+    //! MibReader::setRawCounterDepth().
+    void setRawCounterDepth(quint8 bits) { m_rawCounterDepth = bits; }
+
+    const MibFrameHeader &frameHeader(int globalIndex) const;
+    MibFrameView frame(int globalIndex) const;
+
+private:
+    //! Maps a global index to (reader, local index).
+    int locate(int globalIndex, int *localIndex) const;
+
+    QVector<MibReader *> m_readers;
+    QVector<int> m_firstFrame; //!< Global index of each file's first frame.
+    int m_totalFrames = 0;
+    quint8 m_rawCounterDepth = 12;
+    QString m_errorString;
+};
+
+#endif // MIBFILESET_H
@@ -0,0 +1,136 @@
+#include "mibindex.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <cstring>
+
+namespace MibIndex {
+
+namespace {
+
+// On-disk layout. Plain packed little-endian PODs so the file can be
+// memory-mapped and the records used in place.
+#pragma pack(push, 1)
+struct IndexFileHeader
+{
+    char magic[8];          // "MIBIDX\0\0"
+    quint32 version;
+    quint64 sourceSize;     // size of the .mib when the index was built
+    qint64 sourceMTime;     // mtime (secs since epoch) of the .mib
+    quint32 frameCount;
+};
+
+struct IndexRecord
+{
+    qint64 headerOffset;
+    qint64 dataOffset;
+    qint64 dataSize;
+    quint32 frameNumber;
+    quint16 width;
+    quint16 height;
+    quint8 counterDepth;
+    quint8 rawMode;
+    double exposure;
+    char timestamp[24];     // truncated MQ1 timestamp, NUL padded
+};
+#pragma pack(pop)
+
+const char kMagic[8] = { 'M', 'I', 'B', 'I', 'D', 'X', '\0', '\0' };
+const quint32 kVersion = 1;
+
+} // namespace
+
+QString indexFileName(const QString &mibFileName)
+{
+    return mibFileName + QStringLiteral(".idx");
+}
+
+bool load(const QString &mibFileName, QVector<MibFrameHeader> *frames)
+{
+    const QFileInfo sourceInfo(mibFileName);
+    if (!sourceInfo.exists())
+        return false;
+
+    QFile indexFile(indexFileName(mibFileName));
+    if (!indexFile.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 indexSize = indexFile.size();
+    if (indexSize < qint64(sizeof(IndexFileHeader)))
+        return false;
+    const uchar *map = indexFile.map(0, indexSize);
+    if (!map)
+        return false;
+
+    const IndexFileHeader *header = reinterpret_cast<const IndexFileHeader *>(map);
+    if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+            || header->version != kVersion
+            || header->sourceSize != quint64(sourceInfo.size())
+            || header->sourceMTime != sourceInfo.lastModified().toSecsSinceEpoch()
+            || indexSize < qint64(sizeof(IndexFileHeader))
+                    + qint64(header->frameCount) * qint64(sizeof(IndexRecord))) {
+        return false;
+    }
+
+    const IndexRecord *records = reinterpret_cast<const IndexRecord *>(
+                map + sizeof(IndexFileHeader));
+    frames->resize(int(header->frameCount));
+    for (quint32 i = 0; i < header->frameCount; ++i) {
+        const IndexRecord &rec = records[i];
+        MibFrameHeader &frame = (*frames)[int(i)];
+        frame.headerOffset = rec.headerOffset;
+        frame.dataOffset = rec.dataOffset;
+        frame.dataSize = rec.dataSize;
+        frame.frameNumber = rec.frameNumber;
+        frame.width = rec.width;
+        frame.height = rec.height;
+        frame.counterDepth = rec.counterDepth;
+        frame.rawMode = rec.rawMode != 0;
+        frame.exposure = rec.exposure;
+        frame.timestamp = QByteArray(rec.timestamp,
+                                     int(qstrnlen(rec.timestamp, sizeof(rec.timestamp))));
+    }
+    return true;
+}
+
+bool save(const QString &mibFileName, const QVector<MibFrameHeader> &frames)
+{
+    const QFileInfo sourceInfo(mibFileName);
+    if (!sourceInfo.exists())
+        return false;
+
+    IndexFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.sourceSize = quint64(sourceInfo.size());
+    header.sourceMTime = sourceInfo.lastModified().toSecsSinceEpoch();
+    header.frameCount = quint32(frames.size());
+
+    // QSaveFile so a crash mid-write cannot leave a truncated index that a
+    // later open would have to detect.
+    QSaveFile indexFile(indexFileName(mibFileName));
+    if (!indexFile.open(QIODevice::WriteOnly))
+        return false;
+    indexFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const MibFrameHeader &frame : frames) {
+        IndexRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.headerOffset = frame.headerOffset;
+        rec.dataOffset = frame.dataOffset;
+        rec.dataSize = frame.dataSize;
+        rec.frameNumber = frame.frameNumber;
+        rec.width = frame.width;
+        rec.height = frame.height;
+        rec.counterDepth = frame.counterDepth;
+        rec.rawMode = frame.rawMode ? 1 : 0;
+        rec.exposure = frame.exposure;
+        qstrncpy(rec.timestamp, frame.timestamp.constData(), sizeof(rec.timestamp));
+        indexFile.write(reinterpret_cast<const char *>(&rec), sizeof(rec));
+    }
+    return indexFile.commit();
+}
+
+} // namespace MibIndex
@@ -0,0 +1,32 @@
+#ifndef MIBINDEX_H
+#define MIBINDEX_H
+
+#include <QString>
+#include <QVector>
+
+#include "mibreader.h"
+
+//! Sidecar header-index cache for .mib stacks.
+//!
+//! Scanning every MQ1 header of a 100 GB file over NFS takes minutes; the
+//! scan result is therefore persisted as a compact packed-record file next
+//! to the .mib ("<name>.mib.idx") and memory-mapped on subsequent opens. A
+//! cached index is only trusted if the recorded source size and mtime still
+//! match, so a re-acquired or grown file falls back to a fresh scan.
+namespace MibIndex {
+
+//! Path of the sidecar index for \a mibFileName.
+QString indexFileName(const QString &mibFileName);
+
+//! Loads the cached index for \a mibFileName into \a frames. Returns false
+//! (leaving \a frames untouched) if there is no sidecar, it is stale, or it
+//! is malformed.
+bool load(const QString &mibFileName, QVector<MibFrameHeader> *frames);
+
+//! Writes the sidecar index for \a mibFileName. Best effort: a read-only
+//! data directory just means the next open scans again.
+bool save(const QString &mibFileName, const QVector<MibFrameHeader> &frames);
+
+} // namespace MibIndex
+
+#endif // MIBINDEX_H
@@ -0,0 +1,221 @@
+#include "mibreader.h"
+#include "mibindex.h"
+
+#include <QByteArray>
+#include <QFileInfo>
+#include <QList>
+
+namespace {
+
+// Size in bytes of an unpacked (processed-mode) pixel for the given MQ1 data
+// type field, or 0 if the field denotes raw mode.
+qint64 pixelSizeForDataType(const QByteArray &dataType)
+{
+    if (dataType == "U08")
+        return 1;
+    if (dataType == "U16")
+        return 2;
+    if (dataType == "U32")
+        return 4;
+    if (dataType == "U64")
+        return 8;
+    return 0; // "R64" and friends: packed raw, handled separately
+}
+
+} // namespace
+
+MibReader::MibReader()
+{
+}
+
+MibReader::MibReader(const QString &fileName)
+{
+    open(fileName);
+}
+
+MibReader::~MibReader()
+{
+    close();
+}
+
+bool MibReader::open(const QString &fileName)
+{
+    close();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+    m_fileSize = m_file.size();
+    if (m_fileSize <= 0) {
+        m_errorString = QStringLiteral("File is empty");
+        m_file.close();
+        return false;
+    }
+    // Map the whole file read-only; the OS pages headers and payloads in on
+    // demand, so this is cheap even for 100+ GB stacks.
+    m_map = m_file.map(0, m_fileSize);
+    if (!m_map) {
+        m_errorString = QStringLiteral("Could not memory-map file: %1").arg(m_file.errorString());
+        m_file.close();
+        return false;
+    }
+    // A valid sidecar index makes reopening effectively free; otherwise scan
+    // the headers once and leave an index behind for next time.
+    if (MibIndex::load(fileName, &m_frames))
+        return true;
+    if (!scanHeaders()) {
+        close();
+        return false;
+    }
+    MibIndex::save(fileName, m_frames);
+    return true;
+}
+
+void MibReader::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    for (uchar *map : m_staleMaps)
+        m_file.unmap(map);
+    m_staleMaps.clear();
+    if (m_file.isOpen())
+        m_file.close();
+    m_fileSize = 0;
+    m_frames.clear();
+    m_errorString.clear();
+}
+
+MibFrameView MibReader::frame(int index) const
+{
+    MibFrameView view;
+    if (!m_map || index < 0 || index >= m_frames.size())
+        return view;
+    view.header = m_frames.at(index);
+    view.data = m_map + view.header.dataOffset;
+    view.size = view.header.dataSize;
+    return view;
+}
+
+int MibReader::refresh()
+{
+    if (!m_file.isOpen())
+        return 0;
+    // QFileInfo stats the path fresh; the acquisition software only ever
+    // appends, so growth is the only change we have to pick up.
+    const qint64 newSize = QFileInfo(m_file.fileName()).size();
+    if (newSize <= m_fileSize)
+        return 0;
+    uchar *newMap = m_file.map(0, newSize);
+    if (!newMap)
+        return 0;
+    // Frame views handed out earlier still point into the old mapping, so it
+    // is parked rather than unmapped; address space is free.
+    m_staleMaps.append(m_map);
+    m_map = newMap;
+    m_fileSize = newSize;
+
+    const int before = m_frames.size();
+    if (m_frames.isEmpty()) {
+        scanFrom(0);
+    } else {
+        const MibFrameHeader &last = m_frames.last();
+        scanFrom(last.dataOffset + last.dataSize);
+    }
+    return m_frames.size() - before;
+}
+
+bool MibReader::scanHeaders()
+{
+    m_frames.clear();
+    qint64 offset = 0;
+    MibFrameHeader first;
+    if (!parseHeader(offset, &first)) {
+        m_errorString = QStringLiteral("Not a .mib file: no MQ1 header at offset 0");
+        return false;
+    }
+    m_frames.append(first);
+
+    scanFrom(first.dataOffset + first.dataSize);
+    if (m_frames.isEmpty()) {
+        m_errorString = QStringLiteral("No frames found");
+        return false;
+    }
+    return true;
+}
+
+//! Appends every complete frame from \a offset onward. All frames in one
+//! acquisition share geometry and depth, so the stride is constant: verify
+//! the magic at each stride and stop at the first incomplete or foreign
+//! header (a partially written tail frame is picked up by a later pass).
+void MibReader::scanFrom(qint64 offset)
+{
+    while (offset + 3 <= m_fileSize) {
+        MibFrameHeader header;
+        if (qstrncmp(reinterpret_cast<const char *>(m_map + offset), "MQ1", 3) == 0
+                && parseHeader(offset, &header)) {
+            m_frames.append(header);
+            offset = header.dataOffset + header.dataSize;
+        } else {
+            break;
+        }
+    }
+}
+
+bool MibReader::parseHeader(qint64 offset, MibFrameHeader *header) const
+{
+    // MQ1 headers are comma-separated ASCII; field 2 gives the header size,
+    // which bounds how much we need to look at. A conservative upper bound of
+    // 1 kB covers every header version the Merlin has produced.
+    const qint64 probeSize = qMin<qint64>(1024, m_fileSize - offset);
+    if (probeSize < 32)
+        return false;
+    const QByteArray probe = QByteArray::fromRawData(
+                reinterpret_cast<const char *>(m_map + offset), int(probeSize));
+    if (!probe.startsWith("MQ1,"))
+        return false;
+    const QList<QByteArray> fields = probe.split(',');
+    if (fields.size() < 7)
+        return false;
+
+    bool ok = false;
+    header->headerOffset = offset;
+    header->frameNumber = fields.at(1).toUInt(&ok);
+    if (!ok)
+        return false;
+    const qint64 headerSize = fields.at(2).toLongLong(&ok);
+    if (!ok || headerSize <= 0 || offset + headerSize > m_fileSize)
+        return false;
+    header->width = fields.at(4).toUShort();
+    header->height = fields.at(5).toUShort();
+    if (header->width == 0 || header->height == 0)
+        return false;
+
+    const QByteArray dataType = fields.at(6).trimmed();
+    const qint64 pixelSize = pixelSizeForDataType(dataType);
+    const qint64 pixels = qint64(header->width) * header->height;
+    if (pixelSize > 0) {
+        header->rawMode = false;
+        header->counterDepth = quint8(pixelSize * 8);
+        header->dataSize = pixels * pixelSize;
+    } else {
+        header->rawMode = true;
+        header->counterDepth = m_rawCounterDepth;
+        // Raw payloads pack counterDepth bits per pixel, rows padded to whole
+        // 64-bit words (hence "R64").
+        const qint64 bitsPerRow = qint64(header->width) * header->counterDepth;
+        const qint64 bytesPerRow = ((bitsPerRow + 63) / 64) * 8;
+        header->dataSize = bytesPerRow * header->height;
+    }
+    if (fields.size() > 9)
+        header->timestamp = fields.at(9).trimmed();
+    if (fields.size() > 10)
+        header->exposure = fields.at(10).toDouble();
+
+    header->dataOffset = offset + headerSize;
+    if (header->dataOffset + header->dataSize > m_fileSize)
+        return false;
+    return true;
+}
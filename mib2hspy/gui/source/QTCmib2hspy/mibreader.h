@@ -0,0 +1,99 @@
+#ifndef MIBREADER_H
+#define MIBREADER_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+//! Parsed contents of a single per-frame "MQ1" header.
+//!
+//! Offsets are absolute positions in the mapped file, so a frame payload can
+//! be addressed without touching the header bytes again.
+struct MibFrameHeader
+{
+    qint64 headerOffset = -1;   //!< File offset of the "MQ1" magic.
+    qint64 dataOffset = -1;     //!< File offset of the first payload byte.
+    qint64 dataSize = 0;        //!< Payload size in bytes.
+    quint32 frameNumber = 0;    //!< Sequence number as written by the Merlin.
+    quint16 width = 0;          //!< Frame width in pixels.
+    quint16 height = 0;         //!< Frame height in pixels.
+    quint8 counterDepth = 0;    //!< Counter depth in bits (1, 6, 12 or 24).
+    bool rawMode = false;       //!< True for R64 (packed raw) payloads.
+    double exposure = 0.0;      //!< Exposure time in seconds.
+    QByteArray timestamp;       //!< Acquisition timestamp, verbatim.
+};
+
+//! Zero-copy view of one frame payload inside the mapped file.
+struct MibFrameView
+{
+    const uchar *data = nullptr;
+    qint64 size = 0;
+    MibFrameHeader header;
+
+    bool isValid() const { return data != nullptr; }
+};
+
+//! Memory-mapped reader for Merlin .mib files.
+//!
+//! The file is mapped once and the per-frame MQ1 headers are parsed in place,
+//! so opening a stack costs one scan over the headers only and frame payloads
+//! are handed out as zero-copy views into the mapping. Mirrors what the
+//! Python side does byte-by-byte, without the copies.
+class MibReader
+{
+public:
+    MibReader();
+    explicit MibReader(const QString &fileName);
+    ~MibReader();
+
+    MibReader(const MibReader &) = delete;
+    MibReader &operator=(const MibReader &) = delete;
+
+    //! Maps the file and scans the frame headers. Returns false on failure,
+    //! with the reason available from errorString().
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return m_map != nullptr; }
+
+    //! Re-examines a file that is still being written: remaps it at its new
+    //! size and scans any newly completed frames. Returns the number of
+    //! frames that became visible. Earlier frame views stay valid, because
+    //! the superseded mappings are kept alive until close().
+    int refresh();
+
+    //! Pre-sizes the header table for \a count frames so that refresh() can
+    //! append while other threads read already-published frames.
+    void reserveFrames(int count) { m_frames.reserve(count); }
+
+    QString fileName() const { return m_file.fileName(); }
+    QString errorString() const { return m_errorString; }
+
+    int frameCount() const { return m_frames.size(); }
+    qint64 fileSize() const { return m_fileSize; }
+
+    //! Header of frame \a index; asserts on out-of-range indices.
+    const MibFrameHeader &frameHeader(int index) const { return m_frames.at(index); }
+
+    //! Zero-copy view of the payload of frame \a index. The view stays valid
+    //! until close() is called.
+    MibFrameView frame(int index) const;
+
+    //! Counter depth to assume for raw (R64) payloads whose header does not
+    //! carry one; defaults to 12 bit, the common Merlin configuration.
+    void setRawCounterDepth(quint8 bits) { m_rawCounterDepth = bits; }
+
+private:
+    bool scanHeaders();
+    void scanFrom(qint64 offset);
+    bool parseHeader(qint64 offset, MibFrameHeader *header) const;
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    QVector<uchar *> m_staleMaps; //!< Outgrown mappings, released in close().
+    qint64 m_fileSize = 0;
+    quint8 m_rawCounterDepth = 12;
+    QVector<MibFrameHeader> m_frames;
+    QString m_errorString;
+};
+
+#endif // MIBREADER_H
@@ -0,0 +1,93 @@
+#include "pipelineprofiler.h"
+
+namespace {
+
+const char *stageName(int stage)
+{
+    switch (stage) {
+    case PipelineProfiler::DecodeStage:
+        return "decode";
+    case PipelineProfiler::CompressStage:
+        return "compress";
+    case PipelineProfiler::WriteStage:
+        return "write";
+    default:
+        return "unknown";
+    }
+}
+
+} // namespace
+
+PipelineProfiler::PipelineProfiler()
+{
+    reset();
+}
+
+void PipelineProfiler::reset()
+{
+    for (int i = 0; i < StageCount; ++i) {
+        m_stages[i].nsecs.store(0, std::memory_order_relaxed);
+        m_stages[i].calls.store(0, std::memory_order_relaxed);
+        m_stages[i].bytesIn.store(0, std::memory_order_relaxed);
+        m_stages[i].bytesOut.store(0, std::memory_order_relaxed);
+        m_stages[i].peakQueueDepth.store(0, std::memory_order_relaxed);
+    }
+}
+
+void PipelineProfiler::addSample(Stage stage, qint64 nsecs,
+                                 qint64 bytesIn, qint64 bytesOut)
+{
+    StageCounters &c = m_stages[stage];
+    c.nsecs.fetch_add(nsecs, std::memory_order_relaxed);
+    c.calls.fetch_add(1, std::memory_order_relaxed);
+    c.bytesIn.fetch_add(bytesIn, std::memory_order_relaxed);
+    c.bytesOut.fetch_add(bytesOut, std::memory_order_relaxed);
+}
+
+void PipelineProfiler::recordQueueDepth(Stage stage, int depth)
+{
+    std::atomic<int> &peak = m_stages[stage].peakQueueDepth;
+    int current = peak.load(std::memory_order_relaxed);
+    while (depth > current
+           && !peak.compare_exchange_weak(current, depth,
+                                          std::memory_order_relaxed)) {
+    }
+}
+
+PipelineProfiler::StageTotals PipelineProfiler::totals(Stage stage) const
+{
+    const StageCounters &c = m_stages[stage];
+    StageTotals t;
+    t.nsecs = c.nsecs.load(std::memory_order_relaxed);
+    t.calls = c.calls.load(std::memory_order_relaxed);
+    t.bytesIn = c.bytesIn.load(std::memory_order_relaxed);
+    t.bytesOut = c.bytesOut.load(std::memory_order_relaxed);
+    return t;
+}
+
+int PipelineProfiler::peakQueueDepth(Stage stage) const
+{
+    return m_stages[stage].peakQueueDepth.load(std::memory_order_relaxed);
+}
+
+QJsonObject PipelineProfiler::toJson() const
+{
+    QJsonObject root;
+    for (int i = 0; i < StageCount; ++i) {
+        const StageTotals t = totals(Stage(i));
+        QJsonObject stage;
+        stage.insert(QStringLiteral("busy_ms"), double(t.nsecs) * 1e-6);
+        stage.insert(QStringLiteral("calls"), double(t.calls));
+        stage.insert(QStringLiteral("bytes_in"), double(t.bytesIn));
+        stage.insert(QStringLiteral("bytes_out"), double(t.bytesOut));
+        if (t.nsecs > 0) {
+            stage.insert(QStringLiteral("mb_per_s"),
+                         double(t.bytesIn) / (1024.0 * 1024.0)
+                         / (double(t.nsecs) * 1e-9));
+        }
+        stage.insert(QStringLiteral("peak_queue_depth"),
+                     peakQueueDepth(Stage(i)));
+        root.insert(QLatin1String(stageName(i)), stage);
+    }
+    return root;
+}
@@ -0,0 +1,77 @@
+#ifndef PIPELINEPROFILER_H
+#define PIPELINEPROFILER_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+
+#include <atomic>
+
+//! Lightweight hot-path instrumentation for the conversion pipeline.
+//!
+//! Workers accumulate per-stage wall time, call counts and bytes in/out
+//! with relaxed atomic adds — no locks, no allocation, a few nanoseconds
+//! per sample — so the instrumentation can stay on in production. The GUI
+//! polls snapshot() for the live breakdown and toJson() dumps the totals
+//! on completion, which is usually enough to tell a disk-bound conversion
+//! from an unpack- or compression-bound one without attaching a profiler.
+class PipelineProfiler
+{
+public:
+    enum Stage { DecodeStage, CompressStage, WriteStage, StageCount };
+
+    struct StageTotals
+    {
+        qint64 nsecs = 0;
+        qint64 calls = 0;
+        qint64 bytesIn = 0;
+        qint64 bytesOut = 0;
+    };
+
+    PipelineProfiler();
+
+    void reset();
+
+    //! Called from any worker thread; lock-free.
+    void addSample(Stage stage, qint64 nsecs, qint64 bytesIn, qint64 bytesOut);
+    //! Current depth of the queue feeding \a stage, sampled by producers.
+    void recordQueueDepth(Stage stage, int depth);
+
+    StageTotals totals(Stage stage) const;
+    int peakQueueDepth(Stage stage) const;
+
+    //! Totals of all stages as one JSON object (times in ms, rates in
+    //! MB/s), for the end-of-run dump.
+    QJsonObject toJson() const;
+
+private:
+    struct StageCounters
+    {
+        std::atomic<qint64> nsecs;
+        std::atomic<qint64> calls;
+        std::atomic<qint64> bytesIn;
+        std::atomic<qint64> bytesOut;
+        std::atomic<int> peakQueueDepth;
+    };
+
+    StageCounters m_stages[StageCount];
+};
+
+//! Times one stage invocation; add the sample explicitly on completion so
+//! byte counts can be attached.
+class ScopedStageTimer
+{
+public:
+    ScopedStageTimer() { m_timer.start(); }
+
+    void commit(PipelineProfiler *profiler, PipelineProfiler::Stage stage,
+                qint64 bytesIn, qint64 bytesOut)
+    {
+        if (profiler)
+            profiler->addSample(stage, m_timer.nsecsElapsed(), bytesIn, bytesOut);
+    }
+
+private:
+    QElapsedTimer m_timer;
+};
+
+#endif // PIPELINEPROFILER_H
@@ -0,0 +1,106 @@
+#include "pixelcorrector.h"
+
+#include <QFile>
+#include <QSet>
+#include <QTextStream>
+
+namespace {
+
+// Median of up to eight gathered neighbor values; insertion sort is optimal
+// at these counts. Even counts round down, matching the Python notebook.
+quint16 medianOf(quint16 *values, int count)
+{
+    for (int i = 1; i < count; ++i) {
+        const quint16 v = values[i];
+        int j = i - 1;
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            --j;
+        }
+        values[j + 1] = v;
+    }
+    return values[(count - 1) / 2];
+}
+
+} // namespace
+
+bool PixelCorrector::loadMask(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_errorString = QStringLiteral("Could not open %1").arg(fileName);
+        return false;
+    }
+    m_badPixels.clear();
+    m_table.clear();
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        QString line = stream.readLine();
+        const int comment = line.indexOf(QLatin1Char('#'));
+        if (comment >= 0)
+            line.truncate(comment);
+        const QStringList parts = line.split(QLatin1Char(' '),
+                                             Qt::SkipEmptyParts);
+        if (parts.isEmpty())
+            continue;
+        bool okX = false;
+        bool okY = false;
+        const int x = parts.size() == 2 ? parts.at(0).toInt(&okX) : 0;
+        const int y = parts.size() == 2 ? parts.at(1).toInt(&okY) : 0;
+        if (!okX || !okY) {
+            m_errorString = QStringLiteral("Malformed defect line \"%1\"")
+                    .arg(line.trimmed());
+            m_badPixels.clear();
+            return false;
+        }
+        m_badPixels.append(QPoint(x, y));
+    }
+    return true;
+}
+
+void PixelCorrector::prepare(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_table.clear();
+    m_table.reserve(m_badPixels.size());
+
+    QSet<qint32> bad;
+    for (const QPoint &p : m_badPixels) {
+        if (p.x() >= 0 && p.x() < width && p.y() >= 0 && p.y() < height)
+            bad.insert(p.y() * width + p.x());
+    }
+    for (const QPoint &p : m_badPixels) {
+        if (p.x() < 0 || p.x() >= width || p.y() < 0 || p.y() >= height)
+            continue;
+        CompiledPixel compiled;
+        compiled.index = p.y() * width + p.x();
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx == 0 && dy == 0)
+                    continue;
+                const int nx = p.x() + dx;
+                const int ny = p.y() + dy;
+                if (nx < 0 || nx >= width || ny < 0 || ny >= height)
+                    continue;
+                const qint32 neighbor = ny * width + nx;
+                if (bad.contains(neighbor))
+                    continue;
+                compiled.neighbors[compiled.neighborCount++] = neighbor;
+            }
+        }
+        // A defect with no good neighbors (fully bad cluster) is left as-is.
+        if (compiled.neighborCount > 0)
+            m_table.append(compiled);
+    }
+}
+
+void PixelCorrector::correctFrame(quint16 *frame) const
+{
+    for (const CompiledPixel &compiled : m_table) {
+        quint16 gathered[8];
+        for (int i = 0; i < compiled.neighborCount; ++i)
+            gathered[i] = frame[compiled.neighbors[i]];
+        frame[compiled.index] = medianOf(gathered, compiled.neighborCount);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef PIXELCORRECTOR_H
+#define PIXELCORRECTOR_H
+
+#include <QPoint>
+#include <QString>
+#include <QVector>
+
+//! Dead/hot pixel correction for the decode stage.
+//!
+//! The defect list of a Medipix chip is stable, so the mask is loaded once
+//! and compiled into a flat table of bad-pixel indices with the indices of
+//! their good neighbors precomputed. correctFrame() then replaces each bad
+//! pixel with the median of those neighbors as the frame flows through a
+//! decode worker; the defect set is a few hundred pixels, so the fix-up is
+//! invisible next to the unpack cost.
+class PixelCorrector
+{
+public:
+    //! Loads a defect list: one "x y" pair per line, '#' starts a comment.
+    //! Call prepare() before correcting frames.
+    bool loadMask(const QString &fileName);
+
+    //! Compiles the neighbor table for \a width x \a height frames. Bad
+    //! pixels never contribute to a neighbor median.
+    void prepare(int width, int height);
+
+    //! Replaces every bad pixel of one decoded \a frame in place. Reentrant;
+    //! safe to call from all decode workers at once.
+    void correctFrame(quint16 *frame) const;
+
+    bool isReady() const { return !m_table.isEmpty(); }
+    int badPixelCount() const { return m_badPixels.size(); }
+    QString errorString() const { return m_errorString; }
+
+private:
+    //! One compiled defect: where it sits and which neighbors to blend.
+    struct CompiledPixel
+    {
+        qint32 index = 0;
+        qint32 neighborCount = 0;
+        qint32 neighbors[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    };
+
+    QVector<QPoint> m_badPixels;
+    QVector<CompiledPixel> m_table;
+    int m_width = 0;
+    int m_height = 0;
+    QString m_errorString;
+};
+
+#endif // PIXELCORRECTOR_H
@@ -0,0 +1,169 @@
+#include "previewengine.h"
+#include "bitunpack.h"
+
+#include <climits>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 2x2 sum-bin of a uint16 frame into uint32 bins. This is the only level
+// that reads full-resolution data, so it carries the vector path; the
+// coarser levels work on 4x less data each and stay scalar.
+void bin2x2U16(const quint16 *src, quint32 *dst, int width, int height)
+{
+    const int outWidth = width / 2;
+    for (int y = 0; y < height / 2; ++y) {
+        const quint16 *row0 = src + qint64(2 * y) * width;
+        const quint16 *row1 = row0 + width;
+        quint32 *out = dst + qint64(y) * outWidth;
+        int x = 0;
+#if defined(__AVX2__)
+        const __m256i lowMask = _mm256_set1_epi32(0xFFFF);
+        for (; x + 8 <= outWidth; x += 8) {
+            // 16 u16 per row -> 8 horizontal pair sums per row, then add
+            // the two rows.
+            const __m256i r0 = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(row0 + 2 * x));
+            const __m256i r1 = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(row1 + 2 * x));
+            const __m256i s0 = _mm256_add_epi32(_mm256_and_si256(r0, lowMask),
+                                                _mm256_srli_epi32(r0, 16));
+            const __m256i s1 = _mm256_add_epi32(_mm256_and_si256(r1, lowMask),
+                                                _mm256_srli_epi32(r1, 16));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + x),
+                                _mm256_add_epi32(s0, s1));
+        }
+#endif
+        for (; x < outWidth; ++x) {
+            out[x] = quint32(row0[2 * x]) + row0[2 * x + 1]
+                    + row1[2 * x] + row1[2 * x + 1];
+        }
+    }
+}
+
+// 2x2 sum-bin of an already-binned uint32 level.
+void bin2x2U32(const quint32 *src, quint32 *dst, int width, int height)
+{
+    const int outWidth = width / 2;
+    for (int y = 0; y < height / 2; ++y) {
+        const quint32 *row0 = src + qint64(2 * y) * width;
+        const quint32 *row1 = row0 + width;
+        quint32 *out = dst + qint64(y) * outWidth;
+        for (int x = 0; x < outWidth; ++x) {
+            out[x] = row0[2 * x] + row0[2 * x + 1]
+                    + row1[2 * x] + row1[2 * x + 1];
+        }
+    }
+}
+
+} // namespace
+
+PreviewEngine::PreviewEngine()
+{
+    setCacheBudget(256 * qint64(1024) * 1024);
+}
+
+void PreviewEngine::setCacheBudget(qint64 bytes)
+{
+    m_cache.setMaxCost(int(qMin<qint64>(bytes / 1024, INT_MAX)));
+}
+
+const BinnedFrame *PreviewEngine::binned(int frameIndex, int factor)
+{
+    if (!m_reader || !m_reader->isOpen())
+        return nullptr;
+    if (factor != 1 && factor != 2 && factor != 4 && factor != 8)
+        return nullptr;
+    const quint64 key = (quint64(frameIndex) << 4) | quint64(factor);
+    if (const BinnedFrame *cached = m_cache.object(key))
+        return cached;
+    BinnedFrame *level = buildLevel(frameIndex, factor);
+    if (!level)
+        return nullptr;
+    // QCache costs are ints; account in kB to keep multi-GB budgets in range.
+    const int cost = qMax(1, int(level->sums.size() * qint64(sizeof(quint32)) / 1024));
+    m_cache.insert(key, level, cost);
+    return level;
+}
+
+BinnedFrame *PreviewEngine::buildLevel(int frameIndex, int factor)
+{
+    const MibFrameView view = m_reader->frame(frameIndex);
+    if (!view.isValid())
+        return nullptr;
+    const int width = view.header.width;
+    const int height = view.header.height;
+
+    QVector<quint16> decoded(width * height);
+    if (view.header.rawMode) {
+        if (!MibUnpack::unpackFrameU16(view.data, decoded.data(),
+                                       width, height, view.header.counterDepth))
+            return nullptr;
+    } else if (view.header.counterDepth == 16) {
+        memcpy(decoded.data(), view.data, decoded.size() * sizeof(quint16));
+    } else {
+        const quint8 *src = view.data;
+        const int bytes = view.header.counterDepth / 8;
+        for (int i = 0; i < decoded.size(); ++i) {
+            quint32 v = 0;
+            memcpy(&v, src + qint64(i) * bytes, size_t(bytes));
+            decoded[i] = v > 0xFFFF ? 0xFFFF : quint16(v);
+        }
+    }
+
+    BinnedFrame *level = new BinnedFrame;
+    if (factor == 1) {
+        level->width = width;
+        level->height = height;
+        level->factor = 1;
+        level->sums.resize(width * height);
+        for (int i = 0; i < decoded.size(); ++i)
+            level->sums[i] = decoded.at(i);
+        return level;
+    }
+
+    // First reduction from uint16, then halve with the uint32 kernel until
+    // the requested factor is reached.
+    int w = width / 2;
+    int h = height / 2;
+    level->sums.resize(w * h);
+    bin2x2U16(decoded.constData(), level->sums.data(), width, height);
+    int current = 2;
+    while (current < factor) {
+        QVector<quint32> next((w / 2) * (h / 2));
+        bin2x2U32(level->sums.constData(), next.data(), w, h);
+        level->sums = next;
+        w /= 2;
+        h /= 2;
+        current *= 2;
+    }
+    level->width = w;
+    level->height = h;
+    level->factor = factor;
+    return level;
+}
+
+QImage PreviewEngine::toImage(const BinnedFrame &frame)
+{
+    QImage image(frame.width, frame.height, QImage::Format_Grayscale8);
+    if (frame.sums.isEmpty())
+        return image;
+    quint32 lo = frame.sums.first();
+    quint32 hi = lo;
+    for (quint32 v : frame.sums) {
+        lo = qMin(lo, v);
+        hi = qMax(hi, v);
+    }
+    const double scale = hi > lo ? 255.0 / double(hi - lo) : 0.0;
+    for (int y = 0; y < frame.height; ++y) {
+        uchar *line = image.scanLine(y);
+        const quint32 *src = frame.sums.constData() + qint64(y) * frame.width;
+        for (int x = 0; x < frame.width; ++x)
+            line[x] = uchar((src[x] - lo) * scale);
+    }
+    return image;
+}
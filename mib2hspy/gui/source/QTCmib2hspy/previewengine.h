@@ -0,0 +1,57 @@
+#ifndef PREVIEWENGINE_H
+#define PREVIEWENGINE_H
+
+#include <QCache>
+#include <QImage>
+#include <QVector>
+
+#include "mibreader.h"
+
+//! One level of a frame's binned mipmap pyramid. Bins hold summed counts,
+//! so they stay quantitative for virtual imaging as well as display.
+struct BinnedFrame
+{
+    int width = 0;
+    int height = 0;
+    int factor = 1;             //!< Binning factor relative to the full frame.
+    QVector<quint32> sums;      //!< Row-major summed counts.
+};
+
+//! Thumbnail pyramid generator for the calibrate and preview views.
+//!
+//! For a requested (frame, factor) the engine decodes the frame once from
+//! the mapped file and reduces it through a 2x/4x/8x sum-binned pyramid with
+//! a vectorized first reduction (the only level that touches full-resolution
+//! data). Results are kept in a byte-budgeted cache keyed by frame and
+//! factor, so scrubbing back and forth over a stack re-renders from cache
+//! instead of re-decoding.
+class PreviewEngine
+{
+public:
+    PreviewEngine();
+
+    void setReader(MibReader *reader) { m_reader = reader; }
+
+    //! Cache budget in bytes; default 256 MB.
+    void setCacheBudget(qint64 bytes);
+
+    //! Binned pyramid level for \a frameIndex; \a factor must be 1, 2, 4 or
+    //! 8. Returns null on decode failure. The pointer stays valid until the
+    //! cache evicts the entry, so consume it before the next call.
+    const BinnedFrame *binned(int frameIndex, int factor);
+
+    //! 8-bit grayscale rendering of \a frame, linearly autoscaled between
+    //! its own min and max.
+    static QImage toImage(const BinnedFrame &frame);
+
+    void clear() { m_cache.clear(); }
+
+private:
+    BinnedFrame *buildLevel(int frameIndex, int factor);
+
+    MibReader *m_reader = nullptr;
+    //! Keyed by (frameIndex << 4) | factor.
+    QCache<quint64, BinnedFrame> m_cache;
+};
+
+#endif // PREVIEWENGINE_H
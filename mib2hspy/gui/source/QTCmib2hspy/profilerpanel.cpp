@@ -0,0 +1,67 @@
+#include "profilerpanel.h"
+
+#include <QFormLayout>
+
+namespace {
+
+QString stageTitle(int stage)
+{
+    switch (stage) {
+    case PipelineProfiler::DecodeStage:
+        return ProfilerPanel::tr("Decode");
+    case PipelineProfiler::CompressStage:
+        return ProfilerPanel::tr("Compress");
+    case PipelineProfiler::WriteStage:
+        return ProfilerPanel::tr("Write");
+    default:
+        return QString();
+    }
+}
+
+} // namespace
+
+ProfilerPanel::ProfilerPanel(PipelineProfiler *profiler, QWidget *parent)
+    : QWidget(parent)
+    , m_profiler(profiler)
+{
+    QFormLayout *layout = new QFormLayout(this);
+    for (int i = 0; i < PipelineProfiler::StageCount; ++i) {
+        m_stageLabels[i] = new QLabel(tr("idle"), this);
+        layout->addRow(stageTitle(i), m_stageLabels[i]);
+    }
+    m_pollTimer.setInterval(500);
+    connect(&m_pollTimer, &QTimer::timeout, this, &ProfilerPanel::refresh);
+}
+
+void ProfilerPanel::startPolling()
+{
+    m_pollTimer.start();
+    refresh();
+}
+
+void ProfilerPanel::stopPolling()
+{
+    m_pollTimer.stop();
+    refresh();
+}
+
+void ProfilerPanel::refresh()
+{
+    for (int i = 0; i < PipelineProfiler::StageCount; ++i) {
+        const PipelineProfiler::StageTotals t
+                = m_profiler->totals(PipelineProfiler::Stage(i));
+        if (t.calls == 0) {
+            m_stageLabels[i]->setText(tr("idle"));
+            continue;
+        }
+        const double busyMs = double(t.nsecs) * 1e-6;
+        const double mbPerS = t.nsecs > 0
+                ? double(t.bytesIn) / (1024.0 * 1024.0) / (double(t.nsecs) * 1e-9)
+                : 0.0;
+        m_stageLabels[i]->setText(
+                    tr("%1 ms busy, %2 MB/s, peak queue %3")
+                    .arg(busyMs, 0, 'f', 0)
+                    .arg(mbPerS, 0, 'f', 1)
+                    .arg(m_profiler->peakQueueDepth(PipelineProfiler::Stage(i))));
+    }
+}
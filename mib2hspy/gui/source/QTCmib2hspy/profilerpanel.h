@@ -0,0 +1,36 @@
+#ifndef PROFILERPANEL_H
+#define PROFILERPANEL_H
+
+#include <QLabel>
+#include <QTimer>
+#include <QWidget>
+
+#include "pipelineprofiler.h"
+
+//! Live per-stage breakdown of a running conversion.
+//!
+//! Docked in the supporting-data area of the main window; polls the
+//! profiler twice a second while a conversion runs and shows busy time,
+//! throughput and peak queue depth per stage, so an operator can see at a
+//! glance whether a slow run is unpack-, compression- or disk-bound.
+class ProfilerPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ProfilerPanel(PipelineProfiler *profiler, QWidget *parent = nullptr);
+
+public slots:
+    void startPolling();
+    void stopPolling();
+
+private slots:
+    void refresh();
+
+private:
+    PipelineProfiler *m_profiler;
+    QLabel *m_stageLabels[PipelineProfiler::StageCount];
+    QTimer m_pollTimer;
+};
+
+#endif // PROFILERPANEL_H
@@ -0,0 +1,117 @@
+#include "quicklook.h"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Adds one uint16 source row into the uint32 accumulator row. Same shape as
+// the statistics accumulate kernel; at most 4 rows of 16-bit counts are
+// folded per group, so 32 bits never overflow.
+void addRowU32(const quint16 *src, quint32 *acc, int pixels)
+{
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= pixels; i += 16) {
+        const __m128i lo16 = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(src + i));
+        const __m128i hi16 = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(src + i + 8));
+        __m256i lo = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(acc + i));
+        __m256i hi = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(acc + i + 8));
+        lo = _mm256_add_epi32(lo, _mm256_cvtepu16_epi32(lo16));
+        hi = _mm256_add_epi32(hi, _mm256_cvtepu16_epi32(hi16));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + i), lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + i + 8), hi);
+    }
+#endif
+    for (; i < pixels; ++i)
+        acc[i] += src[i];
+}
+
+// Bins one frame factor x factor: the vectorized kernel sums the rows of
+// each group vertically, then the narrow horizontal fold collapses runs of
+// `factor` accumulator entries with a clamp into uint16.
+void binFrame(const quint16 *src, quint16 *dst, quint32 *rowAccum,
+              int width, int height, int factor)
+{
+    const int binnedWidth = width / factor;
+    for (int by = 0; by < height / factor; ++by) {
+        memset(rowAccum, 0, size_t(width) * sizeof(quint32));
+        for (int r = 0; r < factor; ++r)
+            addRowU32(src + qint64(by * factor + r) * width, rowAccum, width);
+        quint16 *out = dst + qint64(by) * binnedWidth;
+        for (int bx = 0; bx < binnedWidth; ++bx) {
+            quint32 sum = 0;
+            for (int c = 0; c < factor; ++c)
+                sum += rowAccum[bx * factor + c];
+            out[bx] = sum > 0xFFFF ? 0xFFFF : quint16(sum);
+        }
+    }
+}
+
+} // namespace
+
+bool QuickLookExporter::begin(const QString &fileName, int frameCount,
+                              int width, int height, int factor,
+                              int chunkFrames)
+{
+    if ((factor != 2 && factor != 4)
+            || width % factor != 0 || height % factor != 0) {
+        m_errorString = QStringLiteral(
+                    "Quick-look factor must be 2 or 4 and divide the frame "
+                    "geometry (%1x%2)").arg(width).arg(height);
+        return false;
+    }
+    if (!m_writer.create(fileName, frameCount, width / factor,
+                         height / factor, chunkFrames)) {
+        m_errorString = m_writer.errorString();
+        return false;
+    }
+    m_factor = factor;
+    m_width = width;
+    m_height = height;
+    m_rowAccum.resize(width);
+    return true;
+}
+
+bool QuickLookExporter::processBlock(const DecodedBlock &block)
+{
+    const qint64 frameSize = qint64(m_width) * m_height;
+    const qint64 binnedSize = frameSize / (m_factor * m_factor);
+    if (m_staging.size() < binnedSize * block.frameCount)
+        m_staging.resize(int(binnedSize * block.frameCount));
+    for (int i = 0; i < block.frameCount; ++i) {
+        binFrame(block.pixels + frameSize * i,
+                 m_staging.data() + binnedSize * i,
+                 m_rowAccum.data(), m_width, m_height, m_factor);
+    }
+    DecodedBlock binned;
+    binned.firstFrame = block.firstFrame;
+    binned.frameCount = block.frameCount;
+    binned.width = quint16(m_width / m_factor);
+    binned.height = quint16(m_height / m_factor);
+    binned.pixels = m_staging.data();
+    binned.pixelCount = binnedSize * block.frameCount;
+    if (!m_writer.writeBlock(binned)) {
+        m_errorString = m_writer.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool QuickLookExporter::finish()
+{
+    if (!isActive())
+        return true;
+    if (!m_writer.finish()) {
+        m_errorString = m_writer.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef QUICKLOOK_H
+#define QUICKLOOK_H
+
+#include <QString>
+#include <QVector>
+
+#include "conversionpipeline.h"
+#include "hspywriter.h"
+
+//! Streaming "quick-look" export: bins every frame 2x or 4x (summing
+//! counts) while it passes through the pipeline and writes the reduced
+//! stack to its own .hspy, so a remote reviewer downloads a fraction of
+//! the data without a second read pass over the source.
+//!
+//! Binning rides the writer thread: processBlock() is called from the
+//! block sink right next to the full-resolution write, reuses one staging
+//! buffer, and feeds a second HspyWriter sized for the reduced geometry.
+//! Binned sums are clamped into uint16; at 4x a fully saturated detector
+//! would overflow, real diffraction data does not come close.
+class QuickLookExporter
+{
+public:
+    QuickLookExporter() = default;
+
+    QuickLookExporter(const QuickLookExporter &) = delete;
+    QuickLookExporter &operator=(const QuickLookExporter &) = delete;
+
+    void setCodec(HspyWriter::Codec codec) { m_writer.setCodec(codec); }
+    void setCompressionLevel(int level) { m_writer.setCompressionLevel(level); }
+
+    //! Creates the reduced output. \a factor must be 2 or 4 and divide the
+    //! frame geometry; \a chunkFrames must match the pipeline block size.
+    bool begin(const QString &fileName, int frameCount,
+               int width, int height, int factor, int chunkFrames);
+    //! Bins and writes one decoded block; called on the writer thread.
+    bool processBlock(const DecodedBlock &block);
+    bool finish();
+
+    bool isActive() const { return m_factor > 0; }
+    QString errorString() const { return m_errorString; }
+
+private:
+    HspyWriter m_writer;
+    QVector<quint16> m_staging;   //!< One reduced block, reused per call.
+    QVector<quint32> m_rowAccum;  //!< Vertical sums for the row group in flight.
+    int m_factor = 0;
+    int m_width = 0;
+    int m_height = 0;
+    QString m_errorString;
+};
+
+#endif // QUICKLOOK_H
@@ -0,0 +1,72 @@
+#include "reshapemapper.h"
+
+#include <cstring>
+
+ReshapeMapper::ReshapeMapper()
+{
+}
+
+void ReshapeMapper::begin(const ScanGeometry &geometry, HspyWriter *writer)
+{
+    m_geometry = geometry;
+    m_writer = writer;
+    m_chunkCols = writer->chunkFrames();
+    m_frameSize = 0;
+    m_tile.clear();
+    m_tileRow = 0;
+    m_tileColStart = 0;
+    m_tileFill = 0;
+    m_framesDropped = 0;
+}
+
+bool ReshapeMapper::processBlock(const DecodedBlock &block)
+{
+    if (!m_writer)
+        return false;
+    if (m_frameSize == 0) {
+        m_frameSize = qint64(block.width) * block.height;
+        m_tile.resize(int(m_frameSize * m_chunkCols));
+    }
+
+    for (int i = 0; i < block.frameCount; ++i) {
+        const int linear = block.firstFrame + i;
+        const int line = linear / m_geometry.framesPerLine();
+        const int posInLine = linear % m_geometry.framesPerLine();
+        // Flyback frames at the start of each line, and anything beyond the
+        // requested scan area, are dropped here: the "reshape pass" is this
+        // bit of arithmetic.
+        if (posInLine < m_geometry.flybackFrames || line >= m_geometry.scanRows) {
+            ++m_framesDropped;
+            continue;
+        }
+        const int col = posInLine - m_geometry.flybackFrames;
+
+        if (line != m_tileRow || col / m_chunkCols * m_chunkCols != m_tileColStart) {
+            if (m_tileFill > 0 && !flushTile())
+                return false;
+            m_tileRow = line;
+            m_tileColStart = col / m_chunkCols * m_chunkCols;
+            m_tileFill = 0;
+        }
+        memcpy(m_tile.data() + m_frameSize * (col - m_tileColStart),
+               block.pixels + m_frameSize * i,
+               size_t(m_frameSize) * sizeof(quint16));
+        m_tileFill = qMax(m_tileFill, col - m_tileColStart + 1);
+    }
+    return true;
+}
+
+bool ReshapeMapper::finish()
+{
+    if (m_tileFill > 0)
+        return flushTile();
+    return true;
+}
+
+bool ReshapeMapper::flushTile()
+{
+    const bool ok = m_writer->writeTile(m_tileRow, m_tileColStart,
+                                        m_tile.constData(), m_tileFill);
+    m_tileFill = 0;
+    return ok;
+}
@@ -0,0 +1,65 @@
+#ifndef RESHAPEMAPPER_H
+#define RESHAPEMAPPER_H
+
+#include <QVector>
+
+#include "conversionpipeline.h"
+#include "hspywriter.h"
+
+//! Scan geometry of a 4D-STEM acquisition. The detector emits
+//! (scanCols + flybackFrames) frames per scan line; the flyback frames at
+//! the start of each line carry no sample signal and are dropped.
+struct ScanGeometry
+{
+    int scanRows = 0;
+    int scanCols = 0;
+    int flybackFrames = 0;
+
+    int framesPerLine() const { return scanCols + flybackFrames; }
+    int totalFrames() const { return scanRows * framesPerLine(); }
+};
+
+//! Streaming reshape stage between the decode pipeline and the 4D writer.
+//!
+//! Reshaping (n_frames, h, w) into (scan_y, scan_x, h, w) used to require
+//! materializing the whole stack; here it is just arithmetic: each linear
+//! frame index maps to a scan position (or to the bin, for flyback frames)
+//! and lands in a scan-row tile buffer that is flushed to its final chunk
+//! coordinates as soon as it completes. The mapper relies on the pipeline
+//! delivering blocks in frame order, which the writer-thread queue
+//! guarantees.
+class ReshapeMapper
+{
+public:
+    ReshapeMapper();
+
+    //! Must be called before the run; the writer must have been opened
+    //! with create4D() and the same chunkCols as its chunkFrames().
+    void begin(const ScanGeometry &geometry, HspyWriter *writer);
+
+    //! Pipeline sink: routes every frame of \a block to its scan position.
+    bool processBlock(const DecodedBlock &block);
+
+    //! Flushes a trailing partial tile (truncated acquisitions).
+    bool finish();
+
+    int framesDropped() const { return m_framesDropped; }
+
+private:
+    bool flushTile();
+
+    ScanGeometry m_geometry;
+    HspyWriter *m_writer = nullptr;
+    int m_chunkCols = 0;
+    qint64 m_frameSize = 0;
+
+    // Current tile: frames [m_tileColStart, m_tileColStart + m_tileFill)
+    // of scan row m_tileRow.
+    QVector<quint16> m_tile;
+    int m_tileRow = 0;
+    int m_tileColStart = 0;
+    int m_tileFill = 0;
+    int m_framesDropped = 0;
+};
+
+#endif // RESHAPEMAPPER_H
@@ -0,0 +1,144 @@
+#include "settingsstore.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <cstring>
+
+namespace {
+
+// On-disk layout, packed little-endian like the chunk journal. The header
+// is followed by `count` records of two length-prefixed UTF-8 strings
+// (key, then value); everything is pulled in with one readAll() so startup
+// pays a single round trip even on a network share.
+#pragma pack(push, 1)
+struct StoreFileHeader
+{
+    char magic[8];          // "MIBCFG\0\0"
+    quint32 version;
+    quint32 count;
+};
+#pragma pack(pop)
+
+const char kMagic[8] = { 'M', 'I', 'B', 'C', 'F', 'G', '\0', '\0' };
+const quint32 kVersion = 1;
+
+} // namespace
+
+QString SettingsStore::storeFileName(const QString &legacyFileName)
+{
+    return legacyFileName + QStringLiteral(".bin");
+}
+
+bool SettingsStore::loadOrMigrate(const QString &storeFileName,
+                                  const QString &legacyFileName)
+{
+    m_fileName = storeFileName;
+    if (loadBinary(storeFileName))
+        return true;
+    // First run, or an older format version: migrate the text settings
+    // once and leave the binary store behind for the next launch.
+    if (!loadLegacy(legacyFileName))
+        return false;
+    save();
+    return true;
+}
+
+bool SettingsStore::loadBinary(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+    const QByteArray blob = file.readAll();
+
+    StoreFileHeader header;
+    if (blob.size() < int(sizeof(header)))
+        return false;
+    memcpy(&header, blob.constData(), sizeof(header));
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+            || header.version != kVersion) {
+        return false;
+    }
+
+    QHash<QString, QString> values;
+    int pos = int(sizeof(header));
+    for (quint32 i = 0; i < header.count; ++i) {
+        QString parts[2];
+        for (int p = 0; p < 2; ++p) {
+            quint32 length = 0;
+            if (pos + int(sizeof(length)) > blob.size())
+                return false;
+            memcpy(&length, blob.constData() + pos, sizeof(length));
+            pos += int(sizeof(length));
+            if (pos + int(length) > blob.size())
+                return false;
+            parts[p] = QString::fromUtf8(blob.constData() + pos, int(length));
+            pos += int(length);
+        }
+        values.insert(parts[0], parts[1]);
+    }
+    m_values = values;
+    return true;
+}
+
+bool SettingsStore::loadLegacy(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+    // The "SETTINGS" ... "END" framing of the Python GUI's settings.txt;
+    // values may contain ':' (Windows paths), so only the first one splits.
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line == QLatin1String("SETTINGS"))
+            continue;
+        if (line == QLatin1String("END"))
+            break;
+        const int colon = line.indexOf(QLatin1Char(':'));
+        if (colon <= 0)
+            continue;
+        m_values.insert(line.left(colon), line.mid(colon + 1));
+    }
+    return true;
+}
+
+bool SettingsStore::save()
+{
+    if (m_fileName.isEmpty())
+        return false;
+    QByteArray blob;
+    StoreFileHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.count = quint32(m_values.size());
+    blob.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
+        const QByteArray parts[2] = { it.key().toUtf8(),
+                                      it.value().toUtf8() };
+        for (const QByteArray &part : parts) {
+            const quint32 length = quint32(part.size());
+            blob.append(reinterpret_cast<const char *>(&length),
+                        sizeof(length));
+            blob.append(part);
+        }
+    }
+    // QSaveFile commits through a rename, so a crash mid-save leaves the
+    // previous store intact.
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+    file.write(blob);
+    if (!file.commit()) {
+        m_errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
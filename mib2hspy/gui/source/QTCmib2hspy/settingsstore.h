@@ -0,0 +1,58 @@
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <QHash>
+#include <QString>
+
+//! Versioned binary key/value store for the converter settings.
+//!
+//! The legacy settings.txt ("SETTINGS" ... "END" with key:value lines,
+//! shared with the Python GUI) is parsed line by line, which costs a
+//! surprising amount of startup time on NFS home directories. The binary
+//! store is a single packed file pulled in with one read at startup:
+//! a fixed header followed by length-prefixed UTF-8 key/value records.
+//! A missing or stale-version file falls back to a one-time migration
+//! from settings.txt; the legacy file itself is left untouched.
+class SettingsStore
+{
+public:
+    SettingsStore() = default;
+
+    //! Loads the binary store, or migrates \a legacyFileName into it when
+    //! the store is missing or carries an older format version. Returns
+    //! false only if neither file could be read.
+    bool loadOrMigrate(const QString &storeFileName,
+                       const QString &legacyFileName);
+
+    QString value(const QString &key,
+                  const QString &fallback = QString()) const
+    {
+        return m_values.value(key, fallback);
+    }
+    bool contains(const QString &key) const { return m_values.contains(key); }
+
+    //! Updates a key in memory; call save() to persist.
+    void setValue(const QString &key, const QString &value)
+    {
+        m_values.insert(key, value);
+    }
+
+    //! Atomically rewrites the binary store.
+    bool save();
+
+    int count() const { return m_values.size(); }
+    QString errorString() const { return m_errorString; }
+
+    //! The store kept next to \a legacyFileName, with a .bin suffix.
+    static QString storeFileName(const QString &legacyFileName);
+
+private:
+    bool loadBinary(const QString &fileName);
+    bool loadLegacy(const QString &fileName);
+
+    QHash<QString, QString> m_values;
+    QString m_fileName;
+    QString m_errorString;
+};
+
+#endif // SETTINGSSTORE_H
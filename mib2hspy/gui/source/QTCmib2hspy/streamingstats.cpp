@@ -0,0 +1,199 @@
+#include "streamingstats.h"
+
+#include <QThread>
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Per-pixel accumulate of one uint16 frame into a uint32 staging image. The
+// staging image holds at most one block's worth of frames, so it cannot
+// overflow before it is folded into the 64-bit totals.
+void addFrameU32(const quint16 *src, quint32 *acc, qint64 pixels)
+{
+    qint64 i = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= pixels; i += 16) {
+        const __m128i lo16 = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(src + i));
+        const __m128i hi16 = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(src + i + 8));
+        __m256i lo = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(acc + i));
+        __m256i hi = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(acc + i + 8));
+        lo = _mm256_add_epi32(lo, _mm256_cvtepu16_epi32(lo16));
+        hi = _mm256_add_epi32(hi, _mm256_cvtepu16_epi32(hi16));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + i), lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + i + 8), hi);
+    }
+#endif
+    for (; i < pixels; ++i)
+        acc[i] += src[i];
+}
+
+// Per-pixel running maximum.
+void maxFrameU16(const quint16 *src, quint16 *acc, qint64 pixels)
+{
+    qint64 i = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= pixels; i += 16) {
+        const __m256i v = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(src + i));
+        const __m256i m = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(acc + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + i),
+                            _mm256_max_epu16(v, m));
+    }
+#endif
+    for (; i < pixels; ++i)
+        acc[i] = qMax(acc[i], src[i]);
+}
+
+// Sum of the pixels under the detector mask (0xFFFF inside, 0 outside). Row
+// sums fit 32 bits (width * 65535), totals are carried in 64.
+quint64 maskedFrameSum(const quint16 *src, const quint16 *mask,
+                       int width, int height)
+{
+    quint64 total = 0;
+    for (int y = 0; y < height; ++y) {
+        const quint16 *row = src + qint64(y) * width;
+        const quint16 *maskRow = mask + qint64(y) * width;
+        quint32 rowSum = 0;
+        int x = 0;
+#if defined(__AVX2__)
+        __m256i acc = _mm256_setzero_si256();
+        for (; x + 16 <= width; x += 16) {
+            const __m256i v = _mm256_and_si256(
+                        _mm256_loadu_si256(
+                            reinterpret_cast<const __m256i *>(row + x)),
+                        _mm256_loadu_si256(
+                            reinterpret_cast<const __m256i *>(maskRow + x)));
+            const __m128i lo = _mm256_castsi256_si128(v);
+            const __m128i hi = _mm256_extracti128_si256(v, 1);
+            acc = _mm256_add_epi32(acc, _mm256_cvtepu16_epi32(lo));
+            acc = _mm256_add_epi32(acc, _mm256_cvtepu16_epi32(hi));
+        }
+        quint32 lanes[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+        for (int lane = 0; lane < 8; ++lane)
+            rowSum += lanes[lane];
+#endif
+        for (; x < width; ++x)
+            rowSum += row[x] & maskRow[x];
+        total += rowSum;
+    }
+    return total;
+}
+
+} // namespace
+
+StreamingStats::~StreamingStats()
+{
+    qDeleteAll(m_ownedPartials);
+}
+
+void StreamingStats::begin(int width, int height, int frameCount)
+{
+    QMutexLocker locker(&m_mutex);
+    m_width = width;
+    m_height = height;
+    m_frameCount = frameCount;
+    m_virtualBf.clear();
+    if (!m_mask.isEmpty())
+        m_virtualBf.fill(0.0f, frameCount);
+    qDeleteAll(m_ownedPartials);
+    m_ownedPartials.clear();
+    m_partials.clear();
+}
+
+void StreamingStats::setVirtualDisk(int centerX, int centerY, int radius)
+{
+    QVector<quint8> mask(m_width * m_height, 0);
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            const int dx = x - centerX;
+            const int dy = y - centerY;
+            if (dx * dx + dy * dy <= radius * radius)
+                mask[y * m_width + x] = 1;
+        }
+    }
+    setVirtualMask(mask);
+}
+
+void StreamingStats::setVirtualMask(const QVector<quint8> &mask)
+{
+    QMutexLocker locker(&m_mutex);
+    m_mask.resize(mask.size());
+    for (int i = 0; i < mask.size(); ++i)
+        m_mask[i] = mask.at(i) ? 0xFFFF : 0;
+    m_virtualBf.fill(0.0f, m_frameCount);
+}
+
+StreamingStats::Partial *StreamingStats::localPartial()
+{
+    const Qt::HANDLE id = QThread::currentThreadId();
+    QMutexLocker locker(&m_mutex);
+    Partial *partial = m_partials.value(id, nullptr);
+    if (!partial) {
+        partial = new Partial;
+        partial->sum.fill(0, m_width * m_height);
+        partial->stage.resize(m_width * m_height);
+        partial->max.fill(0, m_width * m_height);
+        m_partials.insert(id, partial);
+        m_ownedPartials.append(partial);
+    }
+    return partial;
+}
+
+void StreamingStats::accumulateBlock(const DecodedBlock &block)
+{
+    Partial *partial = localPartial();
+    const qint64 frameSize = qint64(block.width) * block.height;
+    memset(partial->stage.data(), 0, size_t(frameSize) * sizeof(quint32));
+    for (int i = 0; i < block.frameCount; ++i) {
+        const quint16 *frame = block.pixels + frameSize * i;
+        addFrameU32(frame, partial->stage.data(), frameSize);
+        maxFrameU16(frame, partial->max.data(), frameSize);
+        if (!m_mask.isEmpty()) {
+            // Each frame index is visited exactly once across all workers,
+            // so these writes need no synchronization.
+            m_virtualBf[block.firstFrame + i]
+                    = float(maskedFrameSum(frame, m_mask.constData(),
+                                           block.width, block.height));
+        }
+    }
+    quint64 *sum = partial->sum.data();
+    const quint32 *stage = partial->stage.constData();
+    for (qint64 i = 0; i < frameSize; ++i)
+        sum[i] += stage[i];
+}
+
+StreamingStats::Result StreamingStats::merged() const
+{
+    QMutexLocker locker(&m_mutex);
+    Result result;
+    result.width = m_width;
+    result.height = m_height;
+    result.frameCount = m_frameCount;
+    const qint64 frameSize = qint64(m_width) * m_height;
+    result.sumImage.fill(0, frameSize);
+    result.maxPattern.fill(0, frameSize);
+    for (const Partial *partial : m_ownedPartials) {
+        for (qint64 i = 0; i < frameSize; ++i) {
+            result.sumImage[i] += partial->sum.at(i);
+            result.maxPattern[i] = qMax(result.maxPattern.at(i),
+                                        partial->max.at(i));
+        }
+    }
+    result.meanPattern.resize(frameSize);
+    const double scale = m_frameCount > 0 ? 1.0 / m_frameCount : 0.0;
+    for (qint64 i = 0; i < frameSize; ++i)
+        result.meanPattern[i] = float(result.sumImage.at(i) * scale);
+    result.virtualBf = m_virtualBf;
+    return result;
+}
@@ -0,0 +1,79 @@
+#ifndef STREAMINGSTATS_H
+#define STREAMINGSTATS_H
+
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+#include "conversionpipeline.h"
+
+//! One-pass reductions over the decoded frame stream.
+//!
+//! Every decode worker feeds its blocks through accumulateBlock(), which
+//! folds them into a per-thread partial (sum image and max pattern) so the
+//! hot path never takes a lock per pixel; the per-frame virtual bright-field
+//! sums land in disjoint slots of a shared vector and need no locking at
+//! all. merged() combines the partials once the pipeline has drained. This
+//! replaces a second full read of the output in Python just to compute the
+//! standard summary images.
+class StreamingStats
+{
+public:
+    StreamingStats() = default;
+    ~StreamingStats();
+
+    StreamingStats(const StreamingStats &) = delete;
+    StreamingStats &operator=(const StreamingStats &) = delete;
+
+    //! Merged reductions, ready to be stored next to the data.
+    struct Result
+    {
+        int width = 0;
+        int height = 0;
+        int frameCount = 0;
+        QVector<quint64> sumImage;   //!< Per-pixel sum over all frames.
+        QVector<quint16> maxPattern; //!< Per-pixel maximum.
+        QVector<float> meanPattern;  //!< sumImage / frameCount.
+        QVector<float> virtualBf;    //!< Per-frame masked sum; empty without a mask.
+    };
+
+    //! Resets all accumulators for a run over \a frameCount frames of
+    //! \a width x \a height pixels.
+    void begin(int width, int height, int frameCount);
+
+    //! Enables the virtual bright-field reduction with a disk detector of
+    //! \a radius pixels centered on (\a centerX, \a centerY).
+    void setVirtualDisk(int centerX, int centerY, int radius);
+    //! Arbitrary detector: \a mask has width*height entries, nonzero inside.
+    void setVirtualMask(const QVector<quint8> &mask);
+
+    //! Folds one decoded block into the calling thread's partial. Safe to
+    //! call from any number of decode workers concurrently.
+    void accumulateBlock(const DecodedBlock &block);
+
+    //! Merges the per-thread partials; call only after the pipeline has
+    //! finished.
+    Result merged() const;
+
+private:
+    struct Partial
+    {
+        QVector<quint64> sum;
+        QVector<quint32> stage; //!< Per-block uint32 staging, folded into sum.
+        QVector<quint16> max;
+    };
+
+    Partial *localPartial();
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_frameCount = 0;
+    QVector<quint16> m_mask;    //!< 0xFFFF inside the detector, 0 outside.
+    QVector<float> m_virtualBf; //!< Indexed by frame; each frame written once.
+
+    mutable QMutex m_mutex;
+    QHash<Qt::HANDLE, Partial *> m_partials;
+    QVector<Partial *> m_ownedPartials;
+};
+
+#endif // STREAMINGSTATS_H
@@ -0,0 +1,131 @@
+#include "vdsmerge.h"
+
+#include <QVector>
+
+#include <hdf5.h>
+
+namespace HspyMerge {
+
+namespace {
+
+const char *kDataPath = "Experiments/__unnamed__/data";
+
+//! Frame count and geometry of one part's data cube.
+struct PartExtent
+{
+    hsize_t frames = 0;
+    hsize_t height = 0;
+    hsize_t width = 0;
+};
+
+bool readExtent(const QString &fileName, PartExtent *extent,
+                QString *errorMessage)
+{
+    const hid_t file = H5Fopen(fileName.toLocal8Bit().constData(),
+                               H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0) {
+        *errorMessage = QStringLiteral("Could not open %1").arg(fileName);
+        return false;
+    }
+    const hid_t dataset = H5Dopen2(file, kDataPath, H5P_DEFAULT);
+    if (dataset < 0) {
+        H5Fclose(file);
+        *errorMessage = QStringLiteral("%1 has no %2 dataset")
+                .arg(fileName, QLatin1String(kDataPath));
+        return false;
+    }
+    const hid_t space = H5Dget_space(dataset);
+    hsize_t dims[3] = { 0, 0, 0 };
+    const bool ok = H5Sget_simple_extent_ndims(space) == 3
+            && H5Sget_simple_extent_dims(space, dims, nullptr) == 3;
+    H5Sclose(space);
+    H5Dclose(dataset);
+    H5Fclose(file);
+    if (!ok) {
+        *errorMessage = QStringLiteral("%1 is not a rank-3 frame stack")
+                .arg(fileName);
+        return false;
+    }
+    extent->frames = dims[0];
+    extent->height = dims[1];
+    extent->width = dims[2];
+    return true;
+}
+
+} // namespace
+
+bool mergeParts(const QStringList &partFiles, const QString &outputFile,
+                QString *errorMessage)
+{
+    if (partFiles.isEmpty()) {
+        *errorMessage = QStringLiteral("No part files to merge");
+        return false;
+    }
+    QVector<PartExtent> extents;
+    hsize_t totalFrames = 0;
+    for (const QString &partFile : partFiles) {
+        PartExtent extent;
+        if (!readExtent(partFile, &extent, errorMessage))
+            return false;
+        if (!extents.isEmpty()
+                && (extent.height != extents.first().height
+                    || extent.width != extents.first().width)) {
+            *errorMessage = QStringLiteral(
+                        "%1 does not match the frame geometry of %2")
+                    .arg(partFile, partFiles.first());
+            return false;
+        }
+        totalFrames += extent.frames;
+        extents.append(extent);
+    }
+
+    const hid_t file = H5Fcreate(outputFile.toLocal8Bit().constData(),
+                                 H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if (file < 0) {
+        *errorMessage = QStringLiteral("Could not create %1").arg(outputFile);
+        return false;
+    }
+    // Same layout the writer produces, so readers cannot tell a merged
+    // stack from a single-node conversion.
+    const hid_t experiments = H5Gcreate2(file, "Experiments", H5P_DEFAULT,
+                                         H5P_DEFAULT, H5P_DEFAULT);
+    const hid_t group = H5Gcreate2(experiments, "__unnamed__", H5P_DEFAULT,
+                                   H5P_DEFAULT, H5P_DEFAULT);
+
+    const hsize_t dims[3] = { totalFrames, extents.first().height,
+                              extents.first().width };
+    const hid_t vspace = H5Screate_simple(3, dims, nullptr);
+    const hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    bool ok = true;
+    hsize_t offset = 0;
+    for (int i = 0; i < partFiles.size() && ok; ++i) {
+        const hsize_t srcDims[3] = { extents.at(i).frames, dims[1], dims[2] };
+        const hid_t srcSpace = H5Screate_simple(3, srcDims, nullptr);
+        const hsize_t start[3] = { offset, 0, 0 };
+        ok = H5Sselect_hyperslab(vspace, H5S_SELECT_SET, start, nullptr,
+                                 srcDims, nullptr) >= 0
+                && H5Pset_virtual(dcpl, vspace,
+                                  partFiles.at(i).toLocal8Bit().constData(),
+                                  kDataPath, srcSpace) >= 0;
+        H5Sclose(srcSpace);
+        offset += extents.at(i).frames;
+    }
+    if (ok) {
+        const hid_t dataset = H5Dcreate2(group, "data", H5T_STD_U16LE,
+                                         vspace, H5P_DEFAULT, dcpl,
+                                         H5P_DEFAULT);
+        ok = dataset >= 0;
+        if (dataset >= 0)
+            H5Dclose(dataset);
+    }
+    H5Pclose(dcpl);
+    H5Sclose(vspace);
+    H5Gclose(group);
+    H5Gclose(experiments);
+    H5Fclose(file);
+    if (!ok)
+        *errorMessage = QStringLiteral("Could not build the virtual dataset");
+    return ok;
+}
+
+} // namespace HspyMerge
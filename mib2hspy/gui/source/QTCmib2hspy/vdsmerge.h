@@ -0,0 +1,25 @@
+#ifndef VDSMERGE_H
+#define VDSMERGE_H
+
+#include <QString>
+#include <QStringList>
+
+//! Virtual-dataset merge for distributed conversions.
+//!
+//! Each cluster node converts a disjoint frame range of the same .mib into
+//! its own part file (--frame-range); mergeParts() then stitches the parts
+//! into one .hspy whose data is an HDF5 virtual dataset mapping straight
+//! into the parts. No pixel is copied, so the merge takes milliseconds
+//! regardless of stack size — the output just needs the part files to stay
+//! where they are (paths are stored as given, so relative paths travel
+//! with the file set).
+namespace HspyMerge {
+
+//! Stitches \a partFiles, in the given order, into \a outputFile. All
+//! parts must share the frame geometry; sets \a errorMessage on failure.
+bool mergeParts(const QStringList &partFiles, const QString &outputFile,
+                QString *errorMessage);
+
+} // namespace HspyMerge
+
+#endif // VDSMERGE_H
@@ -0,0 +1,86 @@
+#ifndef BATCHQUEUE_H
+#define BATCHQUEUE_H
+
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <functional>
+
+//! One file moving through the batch pipeline.
+struct BatchItem
+{
+    QString inputFile;
+    QString outputFile;
+    QByteArray payload;     //!< Working buffer handed from stage to stage.
+    int frames = 0;         //!< Frame geometry, filled in by the decode
+    int width = 0;          //!< stage for the stages downstream of it.
+    int height = 0;
+    QString error;
+    bool failed = false;
+};
+
+//! Pipelined batch conversion queue.
+//!
+//! Dropped files flow through fixed stages (read, decode, calibrate,
+//! encode, write), each running on its own thread with its own input
+//! queue, so at steady state five different files are in flight at once
+//! and both the disk (read/write ends) and the CPU (middle stages) stay
+//! busy. Per-file latency is unchanged; aggregate files/minute is what
+//! improves. Stage behavior is pluggable: read and write default to
+//! buffered file I/O, the middle stages default to pass-through hooks.
+class BatchQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Stage { ReadStage, DecodeStage, CalibrateStage, EncodeStage, WriteStage, StageCount };
+
+    //! Stage body; return false (and set item->error) to fail the file.
+    using StageFunction = std::function<bool(BatchItem *item)>;
+
+    explicit BatchQueue(QObject *parent = nullptr);
+    ~BatchQueue();
+
+    //! Replaces the body of \a stage. Must be called before start().
+    void setStageFunction(Stage stage, StageFunction function);
+
+    void start();
+    //! Drains in-flight files, then stops the stage threads.
+    void stop();
+
+public slots:
+    //! Queues \a inputFile for conversion to \a outputFile.
+    void enqueue(const QString &inputFile, const QString &outputFile);
+
+signals:
+    void fileFinished(const QString &inputFile, bool success, const QString &error);
+    void backlogChanged(int filesInFlight);
+
+private:
+    friend class BatchStageThread;
+
+    using ItemPtr = QSharedPointer<BatchItem>;
+
+    void push(int stage, const ItemPtr &item);
+    //! Blocks until work arrives for \a stage; returns a null pointer when
+    //! the queue is shutting down.
+    ItemPtr pop(int stage);
+    void itemDone(const ItemPtr &item);
+
+    StageFunction m_functions[StageCount];
+    QVector<QThread *> m_threads;
+
+    QMutex m_mutex;
+    QWaitCondition m_workAvailable[StageCount];
+    QQueue<ItemPtr> m_queues[StageCount];
+    int m_inFlight = 0;
+    bool m_stopping = false;
+    bool m_running = false;
+};
+
+#endif // BATCHQUEUE_H
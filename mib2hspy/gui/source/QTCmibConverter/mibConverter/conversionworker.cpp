@@ -0,0 +1,75 @@
+#include "conversionworker.h"
+
+#include <QMetaObject>
+#include <QProcess>
+
+ConversionWorker::ConversionWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ConversionWorker::setPythonExecutable(const QString &executable)
+{
+    m_python = executable;
+}
+
+void ConversionWorker::enqueue(const ConversionJob &job)
+{
+    m_queue.enqueue(job);
+    emit queueSizeChanged(m_queue.size());
+    if (!m_busy)
+        processNext();
+}
+
+void ConversionWorker::cancelPending()
+{
+    m_queue.clear();
+    emit queueSizeChanged(0);
+}
+
+void ConversionWorker::processNext()
+{
+    if (m_queue.isEmpty()) {
+        m_busy = false;
+        emit idle();
+        return;
+    }
+    m_busy = true;
+    const ConversionJob job = m_queue.dequeue();
+    emit queueSizeChanged(m_queue.size());
+    emit jobStarted(job.inputFile);
+
+    QString message;
+    const bool success = runJob(job, &message);
+    emit jobFinished(job.inputFile, success, message);
+
+    // Re-enter through the event loop instead of recursing, so cancel and
+    // enqueue calls interleave with long queues.
+    QMetaObject::invokeMethod(this, "processNext", Qt::QueuedConnection);
+}
+
+bool ConversionWorker::runJob(const ConversionJob &job, QString *message)
+{
+    // The heavy lifting still happens in the mib2hspy Python package; what
+    // matters here is that it happens on this thread, not the GUI's.
+    QProcess process;
+    QStringList arguments;
+    arguments << QStringLiteral("-m") << QStringLiteral("mib2hspy")
+              << job.inputFile << job.outputFile;
+    if (!job.format.isEmpty())
+        arguments << QStringLiteral("--format") << job.format;
+    process.start(m_python, arguments);
+    if (!process.waitForStarted()) {
+        *message = tr("Could not start %1").arg(m_python);
+        return false;
+    }
+    process.waitForFinished(-1);
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        *message = QString::fromLocal8Bit(process.readAllStandardError()).trimmed();
+        if (message->isEmpty())
+            *message = tr("Converter exited with code %1").arg(process.exitCode());
+        return false;
+    }
+    *message = tr("Wrote %1").arg(job.outputFile);
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef CONVERSIONWORKER_H
+#define CONVERSIONWORKER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QString>
+
+//! One queued decode/convert/export job for the frame converter.
+struct ConversionJob
+{
+    QString inputFile;
+    QString outputFile;
+    QString format; // e.g. "hspy", "tiff", "png"
+};
+
+//! Runs conversion jobs off the GUI thread.
+//!
+//! The worker lives on a QThread owned by MainWindow and drives the Python
+//! frame converter through QProcess, one job at a time, so the UI never
+//! blocks: operators keep queueing frames while a conversion is in flight.
+//! All signals cross back to the GUI thread as queued connections.
+class ConversionWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConversionWorker(QObject *parent = nullptr);
+
+    //! Interpreter used to launch the converter; defaults to "python".
+    void setPythonExecutable(const QString &executable);
+
+public slots:
+    //! Appends a job and starts processing if idle. Safe to call from the
+    //! GUI thread via a queued connection.
+    void enqueue(const ConversionJob &job);
+    //! Finishes the current job, then drops the rest of the queue.
+    void cancelPending();
+
+signals:
+    void jobStarted(const QString &inputFile);
+    void jobFinished(const QString &inputFile, bool success, const QString &message);
+    void queueSizeChanged(int remaining);
+    void idle();
+
+private slots:
+    void processNext();
+
+private:
+    bool runJob(const ConversionJob &job, QString *message);
+
+    QString m_python = QStringLiteral("python");
+    QQueue<ConversionJob> m_queue;
+    bool m_busy = false;
+};
+
+Q_DECLARE_METATYPE(ConversionJob)
+
+#endif // CONVERSIONWORKER_H
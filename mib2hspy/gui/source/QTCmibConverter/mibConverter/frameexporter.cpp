@@ -0,0 +1,299 @@
+#include "frameexporter.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageWriter>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <cstring>
+
+namespace {
+
+void appendLe16(QByteArray *out, quint16 value)
+{
+    const char bytes[2] = { char(value & 0xFF), char(value >> 8) };
+    out->append(bytes, 2);
+}
+
+void appendLe32(QByteArray *out, quint32 value)
+{
+    const char bytes[4] = { char(value & 0xFF), char((value >> 8) & 0xFF),
+                            char((value >> 16) & 0xFF), char(value >> 24) };
+    out->append(bytes, 4);
+}
+
+void appendIfdEntry(QByteArray *out, quint16 tag, quint16 type,
+                    quint32 count, quint32 value)
+{
+    appendLe16(out, tag);
+    appendLe16(out, type);
+    appendLe32(out, count);
+    appendLe32(out, value);
+}
+
+const quint16 kTypeShort = 3;
+const quint16 kTypeLong = 4;
+
+// Minimal baseline TIFF: little-endian, one uncompressed 16-bit grayscale
+// strip directly after the 8-byte header, IFD at the end. Every reader we
+// care about (ImageJ, tifffile, Photoshop) takes this layout.
+void encodeTiff16(const quint16 *pixels, int width, int height,
+                  QByteArray *out)
+{
+    const quint32 dataBytes = quint32(width) * height * 2;
+    const quint32 ifdOffset = 8 + dataBytes;
+    out->clear();
+    out->reserve(int(ifdOffset) + 2 + 9 * 12 + 4);
+    out->append("II", 2);          // little-endian byte order
+    appendLe16(out, 42);
+    appendLe32(out, ifdOffset);
+    // Pixels are host-order uint16; the decode targets are little-endian.
+    out->append(reinterpret_cast<const char *>(pixels), int(dataBytes));
+    appendLe16(out, 9);            // entry count
+    appendIfdEntry(out, 256, kTypeLong, 1, quint32(width));   // ImageWidth
+    appendIfdEntry(out, 257, kTypeLong, 1, quint32(height));  // ImageLength
+    appendIfdEntry(out, 258, kTypeShort, 1, 16);              // BitsPerSample
+    appendIfdEntry(out, 259, kTypeShort, 1, 1);               // Compression
+    appendIfdEntry(out, 262, kTypeShort, 1, 1);               // Photometric
+    appendIfdEntry(out, 273, kTypeLong, 1, 8);                // StripOffsets
+    appendIfdEntry(out, 277, kTypeShort, 1, 1);               // SamplesPerPixel
+    appendIfdEntry(out, 278, kTypeLong, 1, quint32(height));  // RowsPerStrip
+    appendIfdEntry(out, 279, kTypeLong, 1, dataBytes);        // StripByteCounts
+    appendLe32(out, 0);            // no next IFD
+}
+
+bool encodePng(const quint16 *pixels, int width, int height, QByteArray *out)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    const QImage image(reinterpret_cast<const uchar *>(pixels),
+                       width, height, width * 2, QImage::Format_Grayscale16);
+#else
+    // Older Qt has no 16-bit grayscale; exports fall back to the high byte.
+    QImage image(width, height, QImage::Format_Grayscale8);
+    for (int y = 0; y < height; ++y) {
+        uchar *line = image.scanLine(y);
+        const quint16 *src = pixels + qint64(y) * width;
+        for (int x = 0; x < width; ++x)
+            line[x] = uchar(src[x] >> 8);
+    }
+#endif
+    out->clear();
+    QBuffer buffer(out);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, "png");
+    return writer.write(image);
+}
+
+} // namespace
+
+//! One pooled encoder: runs the exporter's claim/decode/encode loop with
+//! its own reused buffers.
+class ExportEncodeTask : public QRunnable
+{
+public:
+    explicit ExportEncodeTask(FrameExporter *exporter)
+        : m_exporter(exporter)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override { m_exporter->encodeLoop(); }
+
+private:
+    FrameExporter *m_exporter;
+};
+
+//! Write-behind I/O thread draining the encoded-frame queue.
+class ExportWriteThread : public QThread
+{
+public:
+    explicit ExportWriteThread(FrameExporter *exporter)
+        : m_exporter(exporter)
+    {
+    }
+
+protected:
+    void run() override { m_exporter->writeLoop(); }
+
+private:
+    FrameExporter *m_exporter;
+};
+
+FrameExporter::FrameExporter(QObject *parent)
+    : QObject(parent)
+{
+    m_threadCount = QThread::idealThreadCount();
+}
+
+FrameExporter::~FrameExporter()
+{
+    cancel();
+    // The encoders keep dereferencing the reader and the queue members
+    // until they notice the cancel, so they must drain before the members
+    // are destroyed — at most one frame's encode away.
+    m_encodePool.waitForDone();
+    if (m_writeThread) {
+        m_writeThread->wait();
+        delete m_writeThread;
+    }
+}
+
+void FrameExporter::setThreadCount(int threads)
+{
+    m_threadCount = qMax(1, threads);
+}
+
+bool FrameExporter::start(const QString &mibFile, const QVector<int> &frames,
+                          const QString &outputDirectory, Format format)
+{
+    if (isRunning())
+        return false;
+    if (!m_reader.open(mibFile)) {
+        m_errorString = m_reader.errorString();
+        return false;
+    }
+    m_frames = frames;
+    if (m_frames.isEmpty()) {
+        m_frames.reserve(m_reader.frameCount());
+        for (int i = 0; i < m_reader.frameCount(); ++i)
+            m_frames.append(i);
+    }
+    m_outputDirectory = outputDirectory;
+    m_baseName = QFileInfo(mibFile).completeBaseName();
+    m_format = format;
+    const MibFrameHeader &first = m_reader.frameHeader(0);
+    m_decoder = MibDecode::select(first.counterDepth, first.rawMode);
+
+    m_running.storeRelease(1);
+    m_cancelled.storeRelease(0);
+    m_encodeFailed.storeRelease(0);
+    m_nextIndex.storeRelease(0);
+    m_framesDone.storeRelease(0);
+    m_writeQueue.clear();
+
+    if (m_writeThread) {
+        m_writeThread->wait();
+        delete m_writeThread;
+    }
+    m_writeThread = new ExportWriteThread(this);
+    m_writeThread->start();
+
+    const int workers = qBound(1, m_threadCount, m_frames.size());
+    m_workersLeft.storeRelease(workers);
+    m_encodePool.setMaxThreadCount(workers);
+    for (int i = 0; i < workers; ++i)
+        m_encodePool.start(new ExportEncodeTask(this));
+    return true;
+}
+
+void FrameExporter::cancel()
+{
+    m_cancelled.storeRelease(1);
+    m_queueNotFull.wakeAll();
+    m_queueNotEmpty.wakeAll();
+}
+
+void FrameExporter::encodeLoop()
+{
+    // Both buffers live for the whole run: the decode scanlines and the
+    // encoder's output are reused frame after frame, so steady state makes
+    // no heap allocations.
+    const MibFrameHeader &first = m_reader.frameHeader(0);
+    QVector<quint16> decoded(int(qint64(first.width) * first.height));
+    QByteArray encoded;
+    const QString extension = m_format == Tiff ? QStringLiteral("tiff")
+                                               : QStringLiteral("png");
+    for (;;) {
+        if (m_cancelled.loadAcquire())
+            break;
+        const int listIndex = m_nextIndex.fetchAndAddOrdered(1);
+        if (listIndex >= m_frames.size())
+            break;
+        const int frame = m_frames.at(listIndex);
+        const MibFrameView view = m_reader.frame(frame);
+        m_decoder(view, decoded.data());
+
+        bool ok = true;
+        if (m_format == Tiff)
+            encodeTiff16(decoded.constData(), first.width, first.height,
+                         &encoded);
+        else
+            ok = encodePng(decoded.constData(), first.width, first.height,
+                           &encoded);
+        if (!ok) {
+            m_encodeFailed.storeRelease(1);
+            cancel();
+            break;
+        }
+        EncodedFrame job;
+        job.fileName = QDir(m_outputDirectory).filePath(
+                    QStringLiteral("%1_%2.%3").arg(m_baseName)
+                    .arg(frame, 5, 10, QLatin1Char('0')).arg(extension));
+        job.bytes = encoded;  // deep copy; the scratch buffer is reused
+        queueEncoded(std::move(job));
+    }
+    workerFinished();
+}
+
+void FrameExporter::queueEncoded(EncodedFrame &&frame)
+{
+    QMutexLocker locker(&m_queueMutex);
+    while (m_writeQueue.size() >= m_queueLimit && !m_cancelled.loadAcquire())
+        m_queueNotFull.wait(&m_queueMutex);
+    if (m_cancelled.loadAcquire())
+        return;
+    m_writeQueue.enqueue(std::move(frame));
+    m_queueNotEmpty.wakeAll();
+}
+
+void FrameExporter::writeLoop()
+{
+    bool writeFailed = false;
+    for (;;) {
+        EncodedFrame frame;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            while (m_writeQueue.isEmpty() && !m_cancelled.loadAcquire()
+                   && m_workersLeft.loadAcquire() > 0) {
+                m_queueNotEmpty.wait(&m_queueMutex, 100);
+            }
+            if (!m_writeQueue.isEmpty()) {
+                frame = m_writeQueue.dequeue();
+                m_queueNotFull.wakeAll();
+            } else if (m_cancelled.loadAcquire()
+                       || m_workersLeft.loadAcquire() == 0) {
+                break;
+            } else {
+                continue;
+            }
+        }
+        QFile file(frame.fileName);
+        if (!file.open(QIODevice::WriteOnly)
+                || file.write(frame.bytes) != frame.bytes.size()) {
+            m_errorString = file.errorString();
+            writeFailed = true;
+            cancel();
+            break;
+        }
+        const int done = m_framesDone.fetchAndAddOrdered(1) + 1;
+        emit progressChanged(done, m_frames.size());
+    }
+    const bool success = !writeFailed && !m_encodeFailed.loadAcquire()
+            && !m_cancelled.loadAcquire()
+            && m_framesDone.loadAcquire() == m_frames.size();
+    if (m_encodeFailed.loadAcquire())
+        m_errorString = QStringLiteral("Frame encoding failed");
+    m_running.storeRelease(0);
+    emit finished(success);
+}
+
+void FrameExporter::workerFinished()
+{
+    m_workersLeft.fetchAndSubOrdered(1);
+    m_queueNotEmpty.wakeAll();
+}
@@ -0,0 +1,103 @@
+#ifndef FRAMEEXPORTER_H
+#define FRAMEEXPORTER_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "decodekernels.h"
+#include "mibreader.h"
+
+//! Native parallel TIFF/PNG frame export.
+//!
+//! Replaces the per-frame round trip through the Python imaging stack for
+//! image exports: frames are decoded straight off the memory-mapped .mib
+//! by a pool of workers, each reusing one decode and one encode buffer
+//! across all its frames, and the encoded bytes are handed to a single
+//! write-behind I/O thread through a bounded queue. Workers therefore
+//! never wait on the disk, and the disk never waits on an encoder, so a
+//! 500-frame selection lands in seconds.
+//!
+//! 16-bit TIFFs are written by a built-in baseline encoder; PNG goes
+//! through Qt's encoder at 16 bits where the Qt version supports
+//! grayscale-16 images.
+class FrameExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format { Tiff, Png };
+
+    explicit FrameExporter(QObject *parent = nullptr);
+    ~FrameExporter();
+
+    //! Encoder count; defaults to QThread::idealThreadCount().
+    void setThreadCount(int threads);
+
+    //! Starts exporting \a frames of \a mibFile into \a outputDirectory as
+    //! "<basename>_NNNNN.<ext>". An empty \a frames list exports the whole
+    //! file. No-op while a run is in flight.
+    bool start(const QString &mibFile, const QVector<int> &frames,
+               const QString &outputDirectory, Format format);
+    void cancel();
+    bool isRunning() const { return m_running.loadAcquire() != 0; }
+
+    QString errorString() const { return m_errorString; }
+
+signals:
+    void progressChanged(int framesDone, int framesTotal);
+    void finished(bool success);
+
+private:
+    friend class ExportEncodeTask;
+    friend class ExportWriteThread;
+
+    struct EncodedFrame
+    {
+        QString fileName;
+        QByteArray bytes;
+    };
+
+    //! Worker loop: claims frames off the shared cursor and encodes them
+    //! with per-worker reused buffers.
+    void encodeLoop();
+    //! I/O thread loop: pops encoded frames and writes them behind the
+    //! encoders.
+    void queueEncoded(EncodedFrame &&frame);
+    void writeLoop();
+    void workerFinished();
+
+    MibReader m_reader;
+    QVector<int> m_frames;
+    QString m_outputDirectory;
+    QString m_baseName;
+    Format m_format = Tiff;
+    MibDecode::FrameDecoder m_decoder = nullptr;
+    int m_threadCount = 0;
+    QString m_errorString;
+
+    //! Exporter-owned pool so teardown can waitForDone() on the encoders;
+    //! tasks on the global pool would outlive a destroyed exporter.
+    QThreadPool m_encodePool;
+
+    QAtomicInt m_running;
+    QAtomicInt m_cancelled;
+    QAtomicInt m_nextIndex;
+    QAtomicInt m_framesDone;
+    QAtomicInt m_workersLeft;
+    QAtomicInt m_encodeFailed;
+
+    QMutex m_queueMutex;
+    QWaitCondition m_queueNotEmpty;
+    QWaitCondition m_queueNotFull;
+    QQueue<EncodedFrame> m_writeQueue;
+    int m_queueLimit = 64;
+    class ExportWriteThread *m_writeThread = nullptr;
+};
+
+#endif // FRAMEEXPORTER_H
@@ -1,15 +1,207 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
+#include <QDir>
+#include <QFileInfo>
+#include <QStatusBar>
+
+#include "decodekernels.h"
+#include "hspywriter.h"
+#include "mibreader.h"
+
+#include <limits>
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , m_worker(new ConversionWorker)
 {
     ui->setupUi(this);
+
+    qRegisterMetaType<ConversionJob>("ConversionJob");
+    m_worker->moveToThread(&m_workerThread);
+    connect(&m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    // Cross-thread: jobs go out and progress comes back through queued
+    // connections, so the GUI thread never touches a running conversion.
+    connect(this, &MainWindow::jobQueued, m_worker, &ConversionWorker::enqueue);
+    connect(m_worker, &ConversionWorker::jobStarted,
+            this, &MainWindow::onJobStarted);
+    connect(m_worker, &ConversionWorker::jobFinished,
+            this, &MainWindow::onJobFinished);
+    connect(m_worker, &ConversionWorker::queueSizeChanged,
+            this, &MainWindow::onQueueSizeChanged);
+    m_workerThread.start();
+
+    m_batchQueue = new BatchQueue(this);
+    connect(m_batchQueue, &BatchQueue::fileFinished,
+            this, &MainWindow::onBatchFileFinished, Qt::QueuedConnection);
+    configureBatchStages();
+    m_batchQueue->start();
+
+    m_frameExporter = new FrameExporter(this);
+    connect(m_frameExporter, &FrameExporter::progressChanged,
+            this, &MainWindow::onExportProgress, Qt::QueuedConnection);
+    connect(m_frameExporter, &FrameExporter::finished,
+            this, &MainWindow::onExportFinished, Qt::QueuedConnection);
 }
 
 MainWindow::~MainWindow()
 {
+    m_batchQueue->stop();
+    m_workerThread.quit();
+    m_workerThread.wait();
     delete ui;
 }
 
+void MainWindow::configureBatchStages()
+{
+    // The batch path runs on the native engine: the memory-mapped reader
+    // plus the specialized decode kernels fill the payload with uint16
+    // frames, and the streaming HDF5 writer turns it into a real .hspy.
+    // The reader does its own I/O through the mapping, so the read stage
+    // shrinks to an up-front existence check; chunk compression happens on
+    // the writer's codec pool, so the encode hook stays free for future
+    // per-file processing.
+    m_batchQueue->setStageFunction(BatchQueue::ReadStage, [](BatchItem *item) {
+        if (!QFileInfo::exists(item->inputFile)) {
+            item->error = tr("No such file");
+            return false;
+        }
+        return true;
+    });
+    m_batchQueue->setStageFunction(BatchQueue::DecodeStage, [](BatchItem *item) {
+        MibReader reader;
+        if (!reader.open(item->inputFile)) {
+            item->error = reader.errorString();
+            return false;
+        }
+        if (reader.frameCount() == 0) {
+            item->error = tr("No frames found");
+            return false;
+        }
+        const MibFrameHeader &proto = reader.frameHeader(0);
+        const qint64 frameSize = qint64(proto.width) * proto.height;
+        const qint64 totalBytes = frameSize * reader.frameCount()
+                * qint64(sizeof(quint16));
+        if (totalBytes > std::numeric_limits<int>::max()) {
+            item->error = tr("Too large for the batch queue; use mib2hspy");
+            return false;
+        }
+        item->frames = reader.frameCount();
+        item->width = proto.width;
+        item->height = proto.height;
+        item->payload.resize(int(totalBytes));
+        quint16 *dst = reinterpret_cast<quint16 *>(item->payload.data());
+        const MibDecode::FrameDecoder decoder =
+                MibDecode::select(proto.counterDepth, proto.rawMode);
+        for (int i = 0; i < item->frames; ++i)
+            decoder(reader.frame(i), dst + frameSize * i);
+        return true;
+    });
+    m_batchQueue->setStageFunction(BatchQueue::WriteStage, [](BatchItem *item) {
+        HspyWriter writer;
+        const int chunkFrames = qMin(item->frames, 64);
+        if (!writer.create(item->outputFile, item->frames,
+                           item->width, item->height, chunkFrames)) {
+            item->error = writer.errorString();
+            return false;
+        }
+        const quint16 *pixels =
+                reinterpret_cast<const quint16 *>(item->payload.constData());
+        const qint64 frameSize = qint64(item->width) * item->height;
+        for (int first = 0; first < item->frames; first += chunkFrames) {
+            DecodedBlock block;
+            block.firstFrame = first;
+            block.frameCount = qMin(chunkFrames, item->frames - first);
+            block.width = item->width;
+            block.height = item->height;
+            block.pixels = const_cast<quint16 *>(pixels) + frameSize * first;
+            block.pixelCount = frameSize * block.frameCount;
+            if (!writer.writeBlock(block)) {
+                item->error = writer.errorString();
+                return false;
+            }
+        }
+        if (!writer.finish()) {
+            item->error = writer.errorString();
+            return false;
+        }
+        item->payload.clear();
+        return true;
+    });
+}
+
+void MainWindow::queueConversion(const QString &inputFile,
+                                 const QString &outputFile,
+                                 const QString &format)
+{
+    ConversionJob job;
+    job.inputFile = inputFile;
+    job.outputFile = outputFile;
+    job.format = format;
+    emit jobQueued(job);
+}
+
+void MainWindow::queueBatch(const QStringList &inputFiles,
+                            const QString &outputDirectory)
+{
+    for (const QString &inputFile : inputFiles) {
+        const QFileInfo info(inputFile);
+        m_batchQueue->enqueue(inputFile,
+                              QDir(outputDirectory).filePath(
+                                  info.completeBaseName() + QStringLiteral(".hspy")));
+    }
+}
+
+void MainWindow::exportFrames(const QString &mibFile, const QVector<int> &frames,
+                              const QString &outputDirectory,
+                              const QString &format)
+{
+    // Image exports run on the native engine; .hspy and everything else
+    // still go through the Python converter queue.
+    const FrameExporter::Format exportFormat =
+            format.compare(QStringLiteral("png"), Qt::CaseInsensitive) == 0
+            ? FrameExporter::Png : FrameExporter::Tiff;
+    if (!m_frameExporter->start(mibFile, frames, outputDirectory, exportFormat)) {
+        statusBar()->showMessage(tr("Export failed: %1")
+                                 .arg(m_frameExporter->errorString()));
+    }
+}
+
+void MainWindow::onExportProgress(int framesDone, int framesTotal)
+{
+    statusBar()->showMessage(tr("Exporting: %1 / %2 frames")
+                             .arg(framesDone).arg(framesTotal));
+}
+
+void MainWindow::onExportFinished(bool success)
+{
+    statusBar()->showMessage(success ? tr("Export finished")
+                                     : tr("Export failed: %1")
+                                       .arg(m_frameExporter->errorString()));
+}
+
+void MainWindow::onBatchFileFinished(const QString &inputFile, bool success,
+                                     const QString &error)
+{
+    statusBar()->showMessage(success ? tr("Converted %1").arg(inputFile)
+                                     : tr("Failed: %1 (%2)").arg(inputFile, error));
+}
+
+void MainWindow::onJobStarted(const QString &inputFile)
+{
+    statusBar()->showMessage(tr("Converting %1…").arg(inputFile));
+}
+
+void MainWindow::onJobFinished(const QString &inputFile, bool success,
+                               const QString &message)
+{
+    statusBar()->showMessage(success ? message
+                                     : tr("Failed: %1 (%2)").arg(inputFile, message));
+}
+
+void MainWindow::onQueueSizeChanged(int remaining)
+{
+    setWindowTitle(remaining > 0 ? tr("mibConverter — %n job(s) queued", "", remaining)
+                                 : tr("mibConverter"));
+}
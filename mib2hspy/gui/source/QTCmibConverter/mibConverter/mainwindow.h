@@ -2,6 +2,11 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QThread>
+
+#include "batchqueue.h"
+#include "conversionworker.h"
+#include "frameexporter.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -15,7 +20,42 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+public slots:
+    //! Queues a conversion job on the background worker; returns
+    //! immediately, so operators can keep queueing frames while a
+    //! conversion is in flight.
+    void queueConversion(const QString &inputFile, const QString &outputFile,
+                         const QString &format = QString());
+
+    //! Sends a whole dropped file set through the pipelined batch queue;
+    //! different files occupy different stages concurrently.
+    void queueBatch(const QStringList &inputFiles, const QString &outputDirectory);
+
+    //! Exports \a frames of \a mibFile as 16-bit TIFF or PNG images on the
+    //! native engine; an empty list exports every frame. \a format is
+    //! "tiff" or "png".
+    void exportFrames(const QString &mibFile, const QVector<int> &frames,
+                      const QString &outputDirectory, const QString &format);
+
+signals:
+    void jobQueued(const ConversionJob &job);
+
+private slots:
+    void onJobStarted(const QString &inputFile);
+    void onJobFinished(const QString &inputFile, bool success, const QString &message);
+    void onQueueSizeChanged(int remaining);
+    void onBatchFileFinished(const QString &inputFile, bool success, const QString &error);
+    void onExportProgress(int framesDone, int framesTotal);
+    void onExportFinished(bool success);
+
 private:
+    //! Installs the native .mib → .hspy stage bodies on the batch queue.
+    void configureBatchStages();
+
     Ui::MainWindow *ui;
+    QThread m_workerThread;
+    ConversionWorker *m_worker; // lives on m_workerThread
+    BatchQueue *m_batchQueue;
+    FrameExporter *m_frameExporter;
 };
 #endif // MAINWINDOW_H
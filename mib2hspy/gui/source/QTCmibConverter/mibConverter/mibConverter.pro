@@ -8,11 +8,35 @@ CONFIG += c++11
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# The native frame exporter and the batch queue reuse the memory-mapped
+# reader, the specialized decode kernels and the streaming HDF5 writer
+# from QTCmib2hspy.
+INCLUDEPATH += ../../QTCmib2hspy
+
+LIBS += -lhdf5 -lz -lzstd -llz4
+
+linux-g++|macx-clang: QMAKE_CXXFLAGS += -mavx2
+win32-msvc: QMAKE_CXXFLAGS += /arch:AVX2
+
 SOURCES += \
+    batchqueue.cpp \
+    conversionworker.cpp \
+    frameexporter.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    ../../QTCmib2hspy/bitunpack.cpp \
+    ../../QTCmib2hspy/chunkjournal.cpp \
+    ../../QTCmib2hspy/decodekernels.cpp \
+    ../../QTCmib2hspy/hspywriter.cpp \
+    ../../QTCmib2hspy/mibindex.cpp \
+    ../../QTCmib2hspy/mibreader.cpp \
+    ../../QTCmib2hspy/pipelineprofiler.cpp \
+    ../../QTCmib2hspy/streamingstats.cpp
 
 HEADERS += \
+    batchqueue.h \
+    conversionworker.h \
+    frameexporter.h \
     mainwindow.h
 
 FORMS += \